@@ -3,4 +3,5 @@
 #include "../develop/matchit/core.h"
 #include "../develop/matchit/expression.h"
 #include "../develop/matchit/patterns.h"
+#include "../develop/matchit/regex.h"
 #include "../develop/matchit/utility.h"
@@ -23,10 +23,42 @@ namespace matchit
             using ValueT = Value &&;
         };
 
-        template <typename Value, typename... Patterns>
-        constexpr auto matchPatterns(Value &&value, Patterns const &...patterns);
+        class NoInstrumentation;
 
-        template <typename Value, bool byRef>
+        template <bool tryOnly, typename Policy, typename Value, typename... Patterns>
+        constexpr decltype(auto) matchPatterns(Value &&value, Patterns const &...patterns);
+
+        template <bool tryOnly, typename Policy, typename Value, typename... PatternPairs,
+                  typename PairsTuple, typename Prepared>
+        constexpr decltype(auto) matchPairs(Value &&value, PairsTuple const &pairs,
+                                            Prepared const &prepared);
+
+        template <typename... PatternPairs, typename PairsTuple>
+        constexpr auto prepareArms(PairsTuple const &pairs);
+
+        template <typename PairsTuple, size_t... I>
+        constexpr auto analyzeArms(PairsTuple const &pairs, std::index_sequence<I...>);
+
+        template <bool tryOnly, typename Policy, typename Value, typename... PatternPairs>
+        class NothrowMatch;
+
+        // The value patterns are matched against, a tuple for many values.
+        template <typename... Values>
+        class MatchedValue
+        {
+        public:
+            using type = std::tuple<Values &&...>;
+        };
+
+        template <typename Value>
+        class MatchedValue<Value>
+        {
+        public:
+            using type = Value;
+        };
+
+        template <typename Value, bool byRef, bool tryOnly = false,
+                  typename Policy = NoInstrumentation>
         class MatchHelper
         {
         private:
@@ -36,32 +68,139 @@ namespace matchit
 
         public:
             template <typename V>
-            constexpr explicit MatchHelper(V &&value) : mValue{std::forward<V>(value)} {}
+            constexpr explicit MatchHelper(V &&value) noexcept : mValue{std::forward<V>(value)} {}
+            // noexcept when no match can be missed and nothing may throw.
             template <typename... PatternPair>
-            constexpr auto operator()(PatternPair const &...patterns)
+            constexpr decltype(auto) operator()(PatternPair const &...patterns) noexcept(
+                NothrowMatch<tryOnly, Policy, ValueT, PatternPair...>::value)
             {
-                return matchPatterns(std::forward<ValueRefT>(mValue), patterns...);
+                return matchPatterns<tryOnly, Policy>(std::forward<ValueRefT>(mValue),
+                                                      patterns...);
             }
         };
 
         template <typename Value>
-        constexpr auto match(Value &&value)
+        constexpr auto match(Value &&value) noexcept
         {
             return MatchHelper<Value, true>{std::forward<Value>(value)};
         }
 
         template <typename First, typename... Values>
-        constexpr auto match(First &&first, Values &&...values)
+        constexpr auto match(First &&first, Values &&...values) noexcept
         {
             auto result = std::forward_as_tuple(std::forward<First>(first),
                                                 std::forward<Values>(values)...);
             return MatchHelper<decltype(result), false>{
                 std::forward<decltype(result)>(result)};
         }
+
+        // match<Policy>(value...) reports the arms tried and taken to Policy.
+        template <typename Policy, typename Value>
+        constexpr auto match(Value &&value) noexcept
+        {
+            return MatchHelper<Value, true, false, Policy>{std::forward<Value>(value)};
+        }
+
+        template <typename Policy, typename First, typename Second, typename... Values>
+        constexpr auto match(First &&first, Second &&second, Values &&...values) noexcept
+        {
+            auto result = std::forward_as_tuple(std::forward<First>(first),
+                                                std::forward<Second>(second),
+                                                std::forward<Values>(values)...);
+            return MatchHelper<decltype(result), false, false, Policy>{
+                std::forward<decltype(result)>(result)};
+        }
+
+        // Like match, but mismatching all patterns gives an empty std::optional
+        // (or false for statements) instead of an error.
+        template <typename Value>
+        constexpr auto tryMatch(Value &&value) noexcept
+        {
+            return MatchHelper<Value, true, true>{std::forward<Value>(value)};
+        }
+
+        template <typename First, typename... Values>
+        constexpr auto tryMatch(First &&first, Values &&...values) noexcept
+        {
+            auto result = std::forward_as_tuple(std::forward<First>(first),
+                                                std::forward<Values>(values)...);
+            return MatchHelper<decltype(result), false, true>{
+                std::forward<decltype(result)>(result)};
+        }
+
+        // Arms kept together to match many values against, with what dispatch
+        // needs from them computed once.
+        template <typename Policy, typename... PatternPairs>
+        class Matcher
+        {
+        private:
+            using PairsT = std::tuple<PatternPairs...>;
+            PairsT mPairs;
+            using PreparedT = decltype(prepareArms<PatternPairs...>(std::declval<PairsT const &>()));
+            PreparedT mPrepared;
+
+            template <bool tryOnly, typename... Values>
+            constexpr decltype(auto) apply(Values &&...values) const
+            {
+                if constexpr (sizeof...(Values) == 1)
+                {
+                    return matchPairs<tryOnly, Policy, Values..., PatternPairs...>(
+                        std::forward<Values>(values)..., mPairs, mPrepared);
+                }
+                else
+                {
+                    auto result = std::forward_as_tuple(std::forward<Values>(values)...);
+                    return matchPairs<tryOnly, Policy, decltype(result), PatternPairs...>(
+                        std::move(result), mPairs, mPrepared);
+                }
+            }
+
+        public:
+            constexpr explicit Matcher(PatternPairs const &...patterns)
+                : mPairs{patterns...}, mPrepared{prepareArms<PatternPairs...>(mPairs)} {}
+            template <typename... Values>
+            constexpr decltype(auto) operator()(Values &&...values) const noexcept(
+                NothrowMatch<false, Policy, typename MatchedValue<Values...>::type,
+                             PatternPairs...>::value)
+            {
+                return apply<false>(std::forward<Values>(values)...);
+            }
+            // Like operator(), but mismatching all patterns gives an empty
+            // std::optional (or false for statements) instead of an error.
+            template <typename... Values>
+            constexpr decltype(auto) tryMatch(Values &&...values) const noexcept(
+                NothrowMatch<true, Policy, typename MatchedValue<Values...>::type,
+                             PatternPairs...>::value)
+            {
+                return apply<true>(std::forward<Values>(values)...);
+            }
+            // Whether the arm can be taken, i.e. it is not subsumed by earlier
+            // arms, e.g. static_assert(m.reachable(2)) for constexpr matchers.
+            constexpr bool reachable(size_t arm) const
+            {
+                return analyzeArms(mPairs, std::make_index_sequence<sizeof...(PatternPairs)>{})
+                    .reachable(arm);
+            }
+        };
+
+        template <typename... PatternPairs>
+        constexpr auto matcher(PatternPairs const &...patterns)
+        {
+            return Matcher<NoInstrumentation, PatternPairs...>{patterns...};
+        }
+
+        // matcher<Policy>(arms...) reports the arms tried and taken to Policy.
+        template <typename Policy, typename... PatternPairs>
+        constexpr auto matcher(PatternPairs const &...patterns)
+        {
+            return Matcher<Policy, PatternPairs...>{patterns...};
+        }
     } // namespace impl
 
     // export symbols
     using impl::match;
+    using impl::matcher;
+    using impl::tryMatch;
 
 } // namespace matchit
 #endif // MATCHIT_CORE_H
@@ -36,6 +36,41 @@ namespace matchit
                            { return v; });
         }
 
+        // Handlers given as plain values are stored by value.
+        template <typename T>
+        class Constant
+        {
+        public:
+            T mValue;
+            constexpr T operator()() const noexcept(std::is_nothrow_copy_constructible_v<T>)
+            {
+                return mValue;
+            }
+        };
+
+        template <typename T>
+        class IsConstant : public std::false_type
+        {
+        };
+
+        template <typename T>
+        class IsConstant<Nullary<Constant<T>>> : public std::true_type
+        {
+        };
+
+        template <typename T>
+        constexpr auto isConstantV = IsConstant<std::decay_t<T>>::value;
+
+        template <typename T>
+        class IsId : public std::false_type
+        {
+        };
+
+        template <typename T>
+        class IsId<Id<T>> : public std::true_type
+        {
+        };
+
         template <typename T>
         constexpr auto toNullary(T &&v)
         {
@@ -43,10 +78,14 @@ namespace matchit
             {
                 return v;
             }
-            else
+            else if constexpr (IsId<std::decay_t<T>>::value)
             {
                 return expr(v);
             }
+            else
+            {
+                return nullary(Constant<std::decay_t<T>>{std::forward<T>(v)});
+            }
         }
 
         // for constant
@@ -137,7 +176,7 @@ namespace matchit
     template <typename T, std::enable_if_t<isNullaryOrIdV<T>, bool> = true> \
     constexpr auto operator op(T const &t)                                  \
     {                                                                       \
-        return nullary([&] { return op evaluate_(t); });                         \
+        return nullary([=] { return op evaluate_(t); });                         \
     }
 
 #define BIN_OP_FOR_NULLARY(op)                                                 \
@@ -146,7 +185,7 @@ namespace matchit
                   true>                                                        \
     constexpr auto operator op(T const &t, U const &u)                         \
     {                                                                          \
-        return nullary([&] { return evaluate_(t) op evaluate_(u); });                    \
+        return nullary([=] { return evaluate_(t) op evaluate_(u); });                    \
     }
 
         // ADL will find these operators.
@@ -202,7 +241,7 @@ namespace matchit
     template <typename T, std::enable_if_t<isUnaryOrWildcardV<T>, bool> = true> \
     constexpr auto operator op(T const &t)                                      \
     {                                                                           \
-        return unary([&](auto &&arg) constexpr { return op evaluate_(t, arg); });    \
+        return unary([=](auto &&arg) constexpr { return op evaluate_(t, arg); });    \
     }
 
 #define BIN_OP_FOR_UNARY(op)                                                   \
@@ -211,7 +250,7 @@ namespace matchit
                                bool> = true>                                   \
     constexpr auto operator op(T const &t, U const &u)                         \
     {                                                                          \
-        return unary([&](auto &&arg) constexpr {                               \
+        return unary([=](auto &&arg) constexpr {                               \
             return evaluate_(t, arg) op evaluate_(u, arg);                               \
         });                                                                    \
     }
@@ -238,6 +277,117 @@ namespace matchit
 
 #undef BIN_OP_FOR_UNARY
 
+        // Interval of values built from comparisons between _ and arithmetic
+        // values, e.g. (lo <= _ && _ < hi). It is kept structured rather than as
+        // an opaque predicate, so that interval arms can be dispatched at once.
+        template <typename T>
+        class Interval
+        {
+            T mLower;
+            T mUpper;
+            bool mHasLower;
+            bool mLowerClosed;
+            bool mHasUpper;
+            bool mUpperClosed;
+
+        public:
+            constexpr Interval(T const &lower, bool hasLower, bool lowerClosed,
+                               T const &upper, bool hasUpper, bool upperClosed)
+                : mLower{lower}, mUpper{upper}, mHasLower{hasLower},
+                  mLowerClosed{lowerClosed}, mHasUpper{hasUpper}, mUpperClosed{upperClosed}
+            {
+            }
+            constexpr static auto above(T const &lower, bool closed)
+            {
+                return Interval{lower, true, closed, lower, false, false};
+            }
+            constexpr static auto below(T const &upper, bool closed)
+            {
+                return Interval{upper, false, false, upper, true, closed};
+            }
+
+            constexpr auto const &lower() const { return mLower; }
+            constexpr auto const &upper() const { return mUpper; }
+            constexpr auto hasLower() const { return mHasLower; }
+            constexpr auto lowerClosed() const { return mLowerClosed; }
+            constexpr auto hasUpper() const { return mHasUpper; }
+            constexpr auto upperClosed() const { return mUpperClosed; }
+
+            template <typename Arg>
+            constexpr bool aboveLower(Arg const &arg) const
+            {
+                return !mHasLower || (mLowerClosed ? mLower <= arg : mLower < arg);
+            }
+            template <typename Arg>
+            constexpr bool belowUpper(Arg const &arg) const
+            {
+                return !mHasUpper || (mUpperClosed ? arg <= mUpper : arg < mUpper);
+            }
+            template <typename Arg>
+            constexpr bool operator()(Arg const &arg) const
+            {
+                return aboveLower(arg) && belowUpper(arg);
+            }
+        };
+
+        template <typename T>
+        class IsUnaryOrWildcard<Interval<T>> : public std::true_type
+        {
+        };
+
+        template <typename T>
+        class EvalTraits<Interval<T>>
+        {
+        public:
+            template <typename Arg>
+            constexpr static decltype(auto) evalImpl(Interval<T> const &e, Arg const &arg)
+            {
+                return e(arg);
+            }
+        };
+
+#define BOUND_OP_FOR_WILDCARD(op, bound, closed)                                 \
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, bool> = true> \
+    constexpr auto operator op(Wildcard const &, T const &v)                     \
+    {                                                                            \
+        return Interval<T>::bound(v, closed);                                    \
+    }
+
+#define BOUND_OP_FOR_VALUE(op, bound, closed)                                    \
+    template <typename T, std::enable_if_t<std::is_arithmetic_v<T>, bool> = true> \
+    constexpr auto operator op(T const &v, Wildcard const &)                     \
+    {                                                                            \
+        return Interval<T>::bound(v, closed);                                    \
+    }
+
+        BOUND_OP_FOR_WILDCARD(<, below, false)
+        BOUND_OP_FOR_WILDCARD(<=, below, true)
+        BOUND_OP_FOR_WILDCARD(>, above, false)
+        BOUND_OP_FOR_WILDCARD(>=, above, true)
+        BOUND_OP_FOR_VALUE(<, above, false)
+        BOUND_OP_FOR_VALUE(<=, above, true)
+        BOUND_OP_FOR_VALUE(>, below, false)
+        BOUND_OP_FOR_VALUE(>=, below, true)
+
+#undef BOUND_OP_FOR_VALUE
+#undef BOUND_OP_FOR_WILDCARD
+
+        // Intersection.
+        template <typename T>
+        constexpr auto operator&&(Interval<T> const &l, Interval<T> const &r)
+        {
+            auto const lowerFromL =
+                !r.hasLower() || (l.hasLower() && (r.lower() < l.lower() ||
+                                                   (!(l.lower() < r.lower()) && !l.lowerClosed())));
+            auto const upperFromL =
+                !r.hasUpper() || (l.hasUpper() && (l.upper() < r.upper() ||
+                                                   (!(r.upper() < l.upper()) && !l.upperClosed())));
+            auto const &lower = lowerFromL ? l : r;
+            auto const &upper = upperFromL ? l : r;
+            return Interval<T>{lower.lower(), lower.hasLower(), lower.lowerClosed(),
+                               upper.upper(), upper.hasUpper(), upper.upperClosed()};
+        }
+
     } // namespace impl
     using impl::expr;
 } // namespace matchit
@@ -1,18 +1,68 @@
 #ifndef MATCHIT_PATTERNS_H
 #define MATCHIT_PATTERNS_H
 
+#include <algorithm>
+#include <any>
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
 #include <functional>
+#include <iterator>
+#include <limits>
+#include <new>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 #include <tuple>
 #include <type_traits>
+#include <typeinfo>
 #include <variant>
 
 #if !defined(NO_SCALAR_REFERENCES_USED_IN_PATTERNS)
 #define NO_SCALAR_REFERENCES_USED_IN_PATTERNS 0
 #endif // !defined(NO_SCALAR_REFERENCES_USED_IN_PATTERNS)
 
+// Whether std::any::type() of the same type is always the same std::type_info
+// object, e.g. without shared libraries or with merged type_info, so that
+// as<T> arms over std::any are looked up comparing addresses only.
+#if !defined(MATCHIT_ANY_TYPE_POINTERS)
+#define MATCHIT_ANY_TYPE_POINTERS 0
+#endif // !defined(MATCHIT_ANY_TYPE_POINTERS)
+
+#if !defined(MATCHIT_NO_EXCEPTIONS)
+#if defined(__cpp_exceptions) || defined(__EXCEPTIONS) || defined(_CPPUNWIND)
+#define MATCHIT_NO_EXCEPTIONS 0
+#else
+#define MATCHIT_NO_EXCEPTIONS 1
+#endif
+#endif // !defined(MATCHIT_NO_EXCEPTIONS)
+
+// Invoked on errors such as no patterns getting matched. It must not return.
+#if !defined(MATCHIT_FAIL)
+#if MATCHIT_NO_EXCEPTIONS
+#define MATCHIT_FAIL(message) (assert(!(message)), std::abort())
+#else
+#define MATCHIT_FAIL(message) throw std::logic_error(message)
+#endif
+#endif // !defined(MATCHIT_FAIL)
+
+// Marks paths proven not to be taken, such as the no-match path of exhaustive
+// matches. Checked by assert, it is an optimization hint under NDEBUG.
+#if !defined(MATCHIT_UNREACHABLE)
+#if !defined(NDEBUG)
+#define MATCHIT_UNREACHABLE(message) (assert(!(message)), std::abort())
+#elif defined(__GNUC__) || defined(__clang__)
+#define MATCHIT_UNREACHABLE(message) __builtin_unreachable()
+#elif defined(_MSC_VER)
+#define MATCHIT_UNREACHABLE(message) __assume(0)
+#else
+#define MATCHIT_UNREACHABLE(message) std::abort()
+#endif
+#endif // !defined(MATCHIT_UNREACHABLE)
+
 namespace matchit
 {
     namespace impl
@@ -82,6 +132,103 @@ namespace matchit
         using SubrangeT = Subrange<typename IterUnderlyingType<RangeType>::beginT,
                                    typename IterUnderlyingType<RangeType>::endT>;
 
+        // The elements from an input iterator, e.g. a std::istreambuf_iterator,
+        // read from it only as far as patterns look at them. Elements read
+        // are kept, so that all arms see the same elements, and the range is
+        // a forward range.
+        template <typename Iter, typename Sentinel = Iter>
+        class InputRange
+        {
+        public:
+            using value_type = typename std::iterator_traits<Iter>::value_type;
+
+        private:
+            mutable Iter mSource;
+            Sentinel mLast;
+            // Elements are never moved once read, unlike in a std::vector.
+            mutable std::deque<value_type> mRead;
+
+            // Reads the elements before pos, as far as there are.
+            void readTo(size_t pos) const
+            {
+                while (mRead.size() < pos && !(mSource == mLast))
+                {
+                    mRead.push_back(*mSource);
+                    ++mSource;
+                }
+            }
+
+            bool endsAt(size_t pos) const
+            {
+                readTo(pos);
+                return mRead.size() <= pos && mSource == mLast;
+            }
+
+        public:
+            class Iterator
+            {
+                constexpr static size_t kEND = SIZE_MAX;
+                InputRange const *mRange = nullptr;
+                size_t mPos = kEND;
+
+            public:
+                using iterator_category = std::forward_iterator_tag;
+                using value_type = typename InputRange::value_type;
+                using difference_type = std::ptrdiff_t;
+                using pointer = value_type const *;
+                using reference = value_type const &;
+
+                Iterator() = default;
+                Iterator(InputRange const *range, size_t pos) : mRange{range}, mPos{pos} {}
+
+                reference operator*() const
+                {
+                    mRange->readTo(mPos + 1);
+                    return mRange->mRead[mPos];
+                }
+                pointer operator->() const { return &**this; }
+                Iterator &operator++()
+                {
+                    ++mPos;
+                    return *this;
+                }
+                Iterator operator++(int)
+                {
+                    auto const it = *this;
+                    ++mPos;
+                    return it;
+                }
+                // The end is only known once the elements before it are read.
+                bool operator==(Iterator const &other) const
+                {
+                    if (mPos == kEND || other.mPos == kEND)
+                    {
+                        return (mPos == kEND || mRange->endsAt(mPos)) ==
+                               (other.mPos == kEND || other.mRange->endsAt(other.mPos));
+                    }
+                    return mPos == other.mPos;
+                }
+                bool operator!=(Iterator const &other) const { return !(*this == other); }
+            };
+
+            InputRange(Iter first, Sentinel last) : mSource{first}, mLast{last} {}
+
+            Iterator begin() const { return {this, 0}; }
+            Iterator end() const { return {this, SIZE_MAX}; }
+            // The number of elements read from the source so far.
+            size_t consumed() const { return mRead.size(); }
+            // The source, past the elements read.
+            Iter const &rest() const { return mSource; }
+        };
+
+        // inputRange(std::istreambuf_iterator<char>{in}) reads from in only the
+        // elements that patterns look at, e.g. the header of a file.
+        template <typename Iter, typename Sentinel = Iter>
+        auto inputRange(Iter first, Sentinel last = Sentinel{})
+        {
+            return InputRange<Iter, Sentinel>{first, last};
+        }
+
         template <typename I, typename S>
         bool operator==(Subrange<I, S> const &lhs, Subrange<I, S> const &rhs)
         {
@@ -237,17 +384,27 @@ namespace matchit
         template <typename Pattern>
         class PatternTraits;
 
-        template <typename... PatternPairs>
+        // Handlers returning the same type, references included, give that
+        // type. Others give their common type.
+        template <typename PatternPair, typename... PatternPairs>
         class PatternPairsRetType
         {
         public:
-            using RetType = std::common_type_t<typename PatternPairs::RetType...>;
+            using RetType = std::conditional_t<
+                (std::is_same_v<typename PatternPair::RetType, typename PatternPairs::RetType> &&
+                 ...),
+                typename PatternPair::RetType,
+                std::common_type_t<typename PatternPair::RetType,
+                                   typename PatternPairs::RetType...>>;
         };
 
         enum class IdProcess : int32_t
         {
             kCANCEL,
-            kCONFIRM
+            kCONFIRM,
+            // Ids of shared matchers are bound in frames, see SharedMatcher.
+            kSHARE,
+            kFRAME
         };
 
         template <typename Pattern>
@@ -270,37 +427,223 @@ namespace matchit
         template <typename... Ts>
         using UniqVariant = typename Variant<UniqueT<Ts...>>::type;
 
+        // Types of the values taken by capture<T> in a pattern, in order.
+        template <typename Pattern>
+        class CaptureTuple
+        {
+        public:
+            using type = std::tuple<>;
+        };
+
+        template <typename Pattern>
+        using CaptureTupleT = typename CaptureTuple<Pattern>::type;
+
+        // Captured values are passed to handlers as lvalues for capture<T &>, and
+        // moved otherwise.
+        template <typename T>
+        using CaptureArgT = std::conditional_t<std::is_lvalue_reference_v<T>, T,
+                                               std::remove_reference_t<T> &&>;
+
+        // Storage for one value of any of Ts, left uninitialized until a value
+        // is put in it. Only used for trivially copyable types, which need no
+        // destruction and can be overwritten by assignment.
         template <typename... Ts>
-        class Context
+        union Slot;
+
+        template <>
+        union Slot<>
         {
-            using ElementT = UniqVariant<Ts...>;
-            using ContainerT = std::array<ElementT, sizeof...(Ts)>;
-            ContainerT mMemHolder;
-            size_t mSize = 0;
+        public:
+            constexpr Slot() : mNone{} {}
+            char mNone;
+        };
 
+        template <typename T, typename... Ts>
+        union Slot<T, Ts...>
+        {
         public:
-            template <typename T>
-            constexpr void emplace_back(T &&t)
+            constexpr Slot() : mRest{} {}
+            template <typename U, std::enable_if_t<std::is_same_v<U, T>, bool> = true>
+            constexpr Slot(std::in_place_type_t<U>, T const &value) : mFirst{value}
+            {
+            }
+            template <typename U, std::enable_if_t<!std::is_same_v<U, T>, bool> = true>
+            constexpr Slot(std::in_place_type_t<U> tag, U const &value) : mRest{tag, value}
+            {
+            }
+            template <typename U>
+            constexpr U &get()
             {
-                mMemHolder[mSize] = std::forward<T>(t);
-                ++mSize;
+                if constexpr (std::is_same_v<U, T>)
+                {
+                    return mFirst;
+                }
+                else
+                {
+                    return mRest.template get<U>();
+                }
             }
-            constexpr auto back() -> ElementT & { return mMemHolder[mSize - 1]; }
+
+            T mFirst;
+            Slot<Ts...> mRest;
+        };
+
+        template <typename Tuple>
+        class SlotOf;
+
+        template <typename... Ts>
+        class SlotOf<std::tuple<Ts...>>
+        {
+        public:
+            using type = Slot<Ts...>;
+        };
+
+        // Which slots hold the values taken by capture<T>, in order.
+        template <size_t nbCaptures>
+        class CaptureIndex
+        {
+        protected:
+            std::array<size_t, nbCaptures> mCaptures{};
+            size_t mNbCaptures = 0;
         };
 
         template <>
-        class Context<>
+        class CaptureIndex<0>
         {
+        protected:
+            constexpr static size_t mNbCaptures = 0;
         };
 
-        template <typename T>
-        class ContextTrait;
+        // Temporaries that patterns of one arm match against, such as App
+        // results, kept while the arm is tried and its handler invoked. Arms
+        // are tried one after another and the ids of mismatched arms are reset,
+        // so all arms of a match share the same nbSlots slots, nbSlots being the
+        // most temporaries any arm needs. Values taken by capture<T> are kept
+        // among them.
+        template <size_t nbSlots, size_t nbCaptures, typename... Ts>
+        class Context : public CaptureIndex<nbCaptures>
+        {
+            constexpr static auto trivial =
+                ((std::is_trivially_copyable_v<Ts> && std::is_trivially_copy_assignable_v<Ts>) && ...);
+            using ElementT = std::conditional_t<trivial, typename SlotOf<UniqueT<Ts...>>::type,
+                                                UniqVariant<Ts...>>;
+            std::array<ElementT, nbSlots> mMemHolder;
+            size_t mSize = 0;
+
+        public:
+            constexpr Context() : mMemHolder{} {}
+            template <typename T>
+            constexpr auto emplace_back(T &&t) -> std::decay_t<T> &
+            {
+                using U = std::decay_t<T>;
+                auto &slot = mMemHolder[mSize++];
+                if constexpr (trivial)
+                {
+                    slot = ElementT{std::in_place_type<U>, t};
+                    return slot.template get<U>();
+                }
+                else
+                {
+                    slot = std::forward<T>(t);
+                    return std::get<U>(slot);
+                }
+            }
+            template <typename T>
+            constexpr void capture(T &&t)
+            {
+                this->mCaptures[this->mNbCaptures++] = mSize;
+                emplace_back(std::forward<T>(t));
+            }
+            // The k-th value captured, as passed to handlers.
+            template <typename T>
+            constexpr CaptureArgT<T> captured(size_t k)
+            {
+                using U = std::conditional_t<std::is_reference_v<T>,
+                                             std::remove_reference_t<T> *, T>;
+                auto &slot = mMemHolder[this->mCaptures[k]];
+                U *value = nullptr;
+                if constexpr (trivial)
+                {
+                    value = &slot.template get<U>();
+                }
+                else
+                {
+                    value = &std::get<U>(slot);
+                }
+                if constexpr (std::is_reference_v<T>)
+                {
+                    return static_cast<CaptureArgT<T>>(**value);
+                }
+                else
+                {
+                    return std::move(*value);
+                }
+            }
+            // Starts over for the next arm.
+            constexpr void rewind()
+            {
+                mSize = 0;
+                if constexpr (nbCaptures > 0)
+                {
+                    this->mNbCaptures = 0;
+                }
+            }
+            // The slots in use, so that an attempt that failed can give back
+            // the slots it took via restore.
+            constexpr auto mark() const { return std::make_pair(mSize, this->mNbCaptures); }
+            constexpr void restore(std::pair<size_t, size_t> const &mark)
+            {
+                mSize = mark.first;
+                if constexpr (nbCaptures > 0)
+                {
+                    this->mNbCaptures = mark.second;
+                }
+            }
+        };
 
         template <typename... Ts>
-        class ContextTrait<std::tuple<Ts...>>
+        class Context<0, 0, Ts...>
         {
         public:
-            using ContextT = Context<Ts...>;
+            constexpr void rewind() {}
+            constexpr auto mark() const { return std::make_pair(size_t{0}, size_t{0}); }
+            constexpr void restore(std::pair<size_t, size_t> const &) {}
+        };
+
+        // The context of matching Value against the patterns of the arms.
+        template <typename Value, typename... PatternPairs>
+        class ContextTrait
+        {
+            template <typename PatternPair>
+            using ArmTuple = typename PatternTraits<
+                typename PatternPair::PatternT>::template AppResultTuple<Value>;
+            using TypeTuple = decltype(std::tuple_cat(std::declval<ArmTuple<PatternPairs>>()...));
+
+            template <typename... Ts>
+            constexpr static auto contextOf(std::tuple<Ts...> const *)
+            {
+                return Context<
+                    std::max({size_t{0}, std::tuple_size_v<ArmTuple<PatternPairs>>...}),
+                    std::max({size_t{0},
+                              std::tuple_size_v<CaptureTupleT<typename PatternPairs::PatternT>>...}),
+                    Ts...>{};
+            }
+
+        public:
+            using ContextT = decltype(contextOf(std::declval<TypeTuple const *>()));
+        };
+
+        template <typename BaseContextT>
+        class InstrumentedContext;
+
+        template <typename ContextT>
+        class IsInstrumented : public std::false_type
+        {
+        };
+
+        template <typename BaseContextT>
+        class IsInstrumented<InstrumentedContext<BaseContextT>> : public std::true_type
+        {
         };
 
         template <typename Value, typename Pattern, typename ConctextT>
@@ -309,17 +652,52 @@ namespace matchit
         {
             auto const result = PatternTraits<Pattern>::matchPatternImpl(
                 std::forward<Value>(value), pattern, depth, context);
+            if constexpr (IsInstrumented<ConctextT>::value)
+            {
+                if (!result)
+                {
+                    context.missAt(depth);
+                }
+            }
             auto const process = result ? IdProcess::kCONFIRM : IdProcess::kCANCEL;
             processId(pattern, depth, process);
             return result;
         }
 
+        // How a handler is invoked: with the captured values when it takes
+        // them, else with no arguments.
+        template <typename Func, typename Captures>
+        class HandlerArgs;
+
+        template <typename Func, typename... Ts>
+        class HandlerArgs<Func, std::tuple<Ts...>>
+        {
+        public:
+            constexpr static auto withCaptures =
+                sizeof...(Ts) > 0 && std::is_invocable_v<Func const &, CaptureArgT<Ts>...>;
+            using ResultWithCaptures = std::invoke_result<Func const &, CaptureArgT<Ts>...>;
+        };
+
         template <typename Pattern, typename Func>
         class PatternPair
         {
+            using ArgsT = HandlerArgs<Func, CaptureTupleT<Pattern>>;
+
+            template <typename ContextT, size_t... K>
+            constexpr decltype(auto) executeWith(ContextT &context,
+                                                 std::index_sequence<K...>) const
+            {
+                return mHandler(
+                    context.template captured<std::tuple_element_t<K, CaptureTupleT<Pattern>>>(
+                        K)...);
+            }
+
         public:
-            using RetType = std::invoke_result_t<Func>;
+            using RetType = typename std::conditional_t<ArgsT::withCaptures,
+                                                        typename ArgsT::ResultWithCaptures,
+                                                        std::invoke_result<Func>>::type;
             using PatternT = Pattern;
+            using HandlerT = Func;
 
             constexpr PatternPair(Pattern const &pattern, Func const &func)
                 : mPattern{pattern}, mHandler{func} {}
@@ -329,7 +707,24 @@ namespace matchit
                 return matchPattern(std::forward<Value>(value), mPattern, /*depth*/ 0,
                                     context);
             }
-            constexpr auto execute() const { return mHandler(); }
+            constexpr decltype(auto) execute() const { return mHandler(); }
+            // Invoked with the values captured in context, if taken.
+            template <typename ContextT>
+            constexpr decltype(auto) execute(ContextT &context) const
+            {
+                if constexpr (ArgsT::withCaptures)
+                {
+                    return executeWith(
+                        context,
+                        std::make_index_sequence<std::tuple_size_v<CaptureTupleT<Pattern>>>{});
+                }
+                else
+                {
+                    static_cast<void>(context);
+                    return mHandler();
+                }
+            }
+            constexpr auto const &pattern() const { return mPattern; }
 
         private:
             Pattern const mPattern;
@@ -362,8 +757,15 @@ namespace matchit
             template <typename Func>
             constexpr auto operator=(Func &&func)
             {
-                auto f = toNullary(func);
-                return PatternPair<Pattern, decltype(f)>{mPattern, f};
+                if constexpr (HandlerArgs<std::decay_t<Func>, CaptureTupleT<Pattern>>::withCaptures)
+                {
+                    return PatternPair<Pattern, std::decay_t<Func>>{mPattern, func};
+                }
+                else
+                {
+                    auto f = toNullary(std::forward<Func>(func));
+                    return PatternPair<Pattern, decltype(f)>{mPattern, f};
+                }
             }
             template <typename Pred>
             constexpr auto operator|(When<Pred> const &w)
@@ -382,6 +784,9 @@ namespace matchit
         template <typename... Patterns>
         constexpr auto ds(Patterns const &...patterns) -> Ds<Patterns...>;
 
+        template <size_t N>
+        class StringLiteral;
+
         template <typename Pattern>
         class OooBinder;
 
@@ -394,12 +799,24 @@ namespace matchit
                 return PatternHelper<Pattern>{p};
             }
 
-            template <typename T>
+            template <typename T, std::enable_if_t<!std::is_same_v<T, char>, bool> = true>
             constexpr auto operator|(T const *p) const
             {
                 return PatternHelper<T const *>{p};
             }
 
+            // Also taking mutable char arrays, which are buffers rather than literals.
+            constexpr auto operator|(char *p) const
+            {
+                return PatternHelper<char const *>{p};
+            }
+
+            template <size_t N>
+            constexpr auto operator|(char const (&str)[N]) const
+            {
+                return PatternHelper<StringLiteral<N - 1>>{StringLiteral<N - 1>{str}};
+            }
+
             template <typename Pattern>
             constexpr auto operator|(OooBinder<Pattern> const &p) const
             {
@@ -435,6 +852,40 @@ namespace matchit
 
         constexpr Wildcard _;
 
+        // Literal with the value known at compile time, enabling switch-like
+        // dispatch over consecutive literal arms.
+        template <auto v>
+        class Literal
+        {
+        public:
+            constexpr static auto value = v;
+        };
+
+        template <auto v>
+        constexpr Literal<v> lit{};
+
+        template <auto v>
+        class PatternTraits<Literal<v>>
+        {
+            using Pattern = Literal<v>;
+
+        public:
+            template <typename Value>
+            using AppResultTuple = std::tuple<>;
+
+            constexpr static auto nbIdV = 0;
+
+            template <typename Value, typename ContextT>
+            constexpr static auto matchPatternImpl(Value &&value, Pattern const &,
+                                                   int32_t /* depth */,
+                                                   ContextT & /*context*/)
+            {
+                return v == std::forward<Value>(value);
+            }
+            constexpr static void processIdImpl(Pattern const &, int32_t /*depth*/,
+                                                IdProcess) {}
+        };
+
         template <>
         class PatternTraits<Wildcard>
         {
@@ -456,6 +907,92 @@ namespace matchit
                                                 IdProcess) {}
         };
 
+        // String literal with the length known at compile time. Char arrays
+        // holding shorter strings, or literals with embedded NULs, are matched
+        // up to their first NUL instead.
+        template <size_t N>
+        class StringLiteral
+        {
+        public:
+            constexpr explicit StringLiteral(char const (&str)[N + 1])
+                : mData{str}, mSize{lengthOf(str)}
+            {
+            }
+            constexpr auto data() const { return mData; }
+            constexpr auto size() const { return mSize; }
+            // Whether the string is N long, as for usual literals.
+            constexpr bool exact() const { return mSize == N; }
+            // Compares with a string of length N, for exact literals.
+            constexpr bool equalSameSize(char const *str) const
+            {
+                return N == 0 || (str[0] == mData[0] &&
+                                  std::char_traits<char>::compare(str + 1, mData + 1, N - 1) == 0);
+            }
+            constexpr bool equal(std::string_view str) const
+            {
+                if (exact())
+                {
+                    return str.size() == N && equalSameSize(str.data());
+                }
+                return str == std::string_view{mData, mSize};
+            }
+
+        private:
+            constexpr static size_t lengthOf(char const (&str)[N + 1])
+            {
+                auto const nul = std::char_traits<char>::find(str, N + 1, '\0');
+                return nul == nullptr ? N + 1 : static_cast<size_t>(nul - str);
+            }
+
+            char const *mData;
+            size_t mSize;
+        };
+
+        template <typename Value>
+        constexpr auto isStringLikeV = std::is_convertible_v<Value, std::string_view>;
+
+        template <size_t N, typename Value>
+        constexpr bool equalString(StringLiteral<N> const &strPat, Value const &value)
+        {
+            if constexpr (std::is_pointer_v<std::decay_t<Value>>)
+            {
+                if (value == nullptr)
+                {
+                    return false;
+                }
+            }
+            return strPat.equal(value);
+        }
+
+        template <size_t N>
+        class PatternTraits<StringLiteral<N>>
+        {
+            using Pattern = StringLiteral<N>;
+
+        public:
+            template <typename Value>
+            using AppResultTuple = std::tuple<>;
+
+            constexpr static auto nbIdV = 0;
+
+            template <typename Value, typename ContextT>
+            constexpr static auto matchPatternImpl(Value &&value, Pattern const &strPat,
+                                                   int32_t /* depth */,
+                                                   ContextT & /*context*/)
+            {
+                if constexpr (isStringLikeV<Value const &>)
+                {
+                    return equalString(strPat, value);
+                }
+                else
+                {
+                    return strPat.data() == std::forward<Value>(value);
+                }
+            }
+            constexpr static void processIdImpl(Pattern const &, int32_t /*depth*/,
+                                                IdProcess) {}
+        };
+
         template <typename... Patterns>
         class Or
         {
@@ -544,26 +1081,261 @@ namespace matchit
                                                 IdProcess) {}
         };
 
-        template <typename Unary, typename Pattern>
-        class App
+        template <typename T>
+        class PatternTraits<Interval<T>>
         {
         public:
-            constexpr App(Unary &&unary, Pattern const &pattern)
-                : mUnary{std::forward<Unary>(unary)}, mPattern{pattern} {}
-            constexpr auto const &unary() const { return mUnary; }
-            constexpr auto const &pattern() const { return mPattern; }
+            template <typename Value>
+            using AppResultTuple = std::tuple<>;
 
-        private:
-            Unary const mUnary;
-            InternalPatternT<Pattern> const mPattern;
-        };
+            constexpr static auto nbIdV = 0;
 
-        template <typename Unary, typename Pattern>
+            template <typename Value, typename ContextT>
+            constexpr static auto matchPatternImpl(Value &&value,
+                                                   Interval<T> const &intervalPat,
+                                                   int32_t /* depth */, ContextT &)
+            {
+                return intervalPat(std::forward<Value>(value));
+            }
+            constexpr static void processIdImpl(Interval<T> const &, int32_t /*depth*/,
+                                                IdProcess) {}
+        };
+
+        template <typename Unary, typename Pattern>
+        class App
+        {
+        public:
+            constexpr App(Unary &&unary, Pattern const &pattern)
+                : mUnary{std::forward<Unary>(unary)}, mPattern{pattern} {}
+            constexpr auto const &unary() const { return mUnary; }
+            constexpr auto const &pattern() const { return mPattern; }
+
+        private:
+            Unary const mUnary;
+            InternalPatternT<Pattern> const mPattern;
+        };
+
+        template <typename Unary, typename Pattern>
         constexpr auto app(Unary &&unary, Pattern const &pattern)
         {
             return App<Unary, Pattern>{std::forward<Unary>(unary), pattern};
         }
 
+        // Whether invoking Unary is known to be pure. Member accesses are, and
+        // the library marks its own casts and dereferences as such. Users can
+        // specialize it for their own unaries.
+        template <typename Unary>
+        class PureUnary : public std::is_member_object_pointer<Unary>
+        {
+        };
+
+        // Projections of App patterns with pure unaries and reference or scalar
+        // results are memoized across arms of one match, so that the same
+        // cast / dereference / member access is done at most once per input.
+        template <typename Unary, typename Value>
+        class Projection
+        {
+        public:
+            using UnaryT = Unary;
+            using ValueT = Value;
+            using ResultT = typename std::conditional_t<std::is_invocable_v<Unary, Value &>,
+                                                        std::invoke_result<Unary, Value &>,
+                                                        std::common_type<void>>::type;
+            constexpr static auto memoizable =
+                PureUnary<Unary>::value &&
+                (std::is_lvalue_reference_v<ResultT> || std::is_scalar_v<ResultT>);
+        };
+
+        template <typename Key>
+        class ProjectionSlot
+        {
+            using UnaryT = typename Key::UnaryT;
+            using ValueT = typename Key::ValueT;
+            using ResultT = typename Key::ResultT;
+            // Scalar inputs are compared by value, others by address.
+            constexpr static auto byValue = std::is_scalar_v<ValueT>;
+            using InputT = std::conditional_t<byValue, std::remove_cv_t<ValueT>, void const *>;
+            using StoredT = std::conditional_t<std::is_lvalue_reference_v<ResultT>,
+                                               std::remove_reference_t<ResultT> *,
+                                               std::remove_cv_t<ResultT>>;
+            // Empty unaries are all equal, no need to store them.
+            using StoredUnaryT = std::conditional_t<std::is_empty_v<UnaryT>, bool, UnaryT>;
+
+            bool mValid{};
+            StoredUnaryT mUnary{};
+            InputT mInput{};
+            StoredT mResult{};
+
+        public:
+            constexpr ResultT project(UnaryT const &unary, ValueT &value)
+            {
+                auto const input = [&]
+                {
+                    if constexpr (byValue)
+                    {
+                        return static_cast<InputT>(value);
+                    }
+                    else
+                    {
+                        return static_cast<void const *>(std::addressof(value));
+                    }
+                }();
+                auto sameUnary = true;
+                if constexpr (!std::is_empty_v<UnaryT>)
+                {
+                    sameUnary = mUnary == unary;
+                }
+                if (!mValid || !sameUnary || !(mInput == input))
+                {
+                    if constexpr (std::is_lvalue_reference_v<ResultT>)
+                    {
+                        mResult = std::addressof(invoke_(unary, value));
+                    }
+                    else
+                    {
+                        mResult = invoke_(unary, value);
+                    }
+                    if constexpr (!std::is_empty_v<UnaryT>)
+                    {
+                        mUnary = unary;
+                    }
+                    mInput = input;
+                    mValid = true;
+                }
+                if constexpr (std::is_lvalue_reference_v<ResultT>)
+                {
+                    return *mResult;
+                }
+                else
+                {
+                    return mResult;
+                }
+            }
+        };
+
+        template <typename... Keys>
+        class Memo
+        {
+            std::tuple<ProjectionSlot<Keys>...> mSlots;
+
+        public:
+            template <typename Key>
+            constexpr static auto contains = WithinTypes<Key, Keys...>::value;
+
+            template <typename Key>
+            constexpr auto &slot()
+            {
+                return std::get<ProjectionSlot<Key>>(mSlots);
+            }
+        };
+
+        // Context sharing the memo of one match.
+        template <typename ContextT, typename MemoT>
+        class SharedContext : public ContextT
+        {
+            MemoT &mMemo;
+            // How many values kept in slots are being matched. Slots are reused
+            // by later arms, so projections of these values, memoized by
+            // address, could refer to destroyed objects and are not memoized.
+            size_t mNbInSlot = 0;
+
+        public:
+            constexpr explicit SharedContext(MemoT &memo) : ContextT{}, mMemo{memo} {}
+            constexpr auto &memo() { return mMemo; }
+            constexpr void enterSlot() { ++mNbInSlot; }
+            constexpr void leaveSlot() { --mNbInSlot; }
+            constexpr bool inSlot() const { return mNbInSlot > 0; }
+        };
+
+        template <typename ContextT, typename Key>
+        class IsMemoized : public std::false_type
+        {
+        };
+
+        template <typename ContextT, typename MemoT, typename Key>
+        class IsMemoized<SharedContext<ContextT, MemoT>, Key>
+            : public std::bool_constant<MemoT::template contains<Key>>
+        {
+        };
+
+        // Context of instrumented matches, also telling how deep the arm being
+        // tried went before failing.
+        template <typename BaseContextT>
+        class InstrumentedContext : public BaseContextT
+        {
+            int32_t mMissDepth = -1;
+
+        public:
+            using BaseContextT::BaseContextT;
+            constexpr void missAt(int32_t depth) { mMissDepth = std::max(mMissDepth, depth); }
+            constexpr auto missDepth() const { return mMissDepth; }
+            constexpr void clearMiss() { mMissDepth = -1; }
+        };
+
+        template <typename BaseContextT, typename Key>
+        class IsMemoized<InstrumentedContext<BaseContextT>, Key> : public IsMemoized<BaseContextT, Key>
+        {
+        };
+
+        template <typename ContextT, typename Key>
+        constexpr auto isMemoizedV = IsMemoized<std::decay_t<ContextT>, Key>::value;
+
+        template <typename ContextT>
+        class SharesMemo : public std::false_type
+        {
+        };
+
+        template <typename ContextT, typename MemoT>
+        class SharesMemo<SharedContext<ContextT, MemoT>> : public std::true_type
+        {
+        };
+
+        template <typename BaseContextT>
+        class SharesMemo<InstrumentedContext<BaseContextT>> : public SharesMemo<BaseContextT>
+        {
+        };
+
+        // Matches a value kept in a slot of the context.
+        template <typename Value, typename Pattern, typename ContextT>
+        constexpr bool matchInSlot(Value &&value, Pattern const &pattern, int32_t depth,
+                                   ContextT &context)
+        {
+            if constexpr (SharesMemo<ContextT>::value)
+            {
+                context.enterSlot();
+                auto const result =
+                    matchPattern(std::forward<Value>(value), pattern, depth, context);
+                context.leaveSlot();
+                return result;
+            }
+            else
+            {
+                return matchPattern(std::forward<Value>(value), pattern, depth, context);
+            }
+        }
+
+        // Instrumentation policy of matches, told about the arms tried and taken.
+        // Policies derive from it to override some of these hooks. This one does
+        // nothing and costs nothing.
+        class NoInstrumentation
+        {
+        public:
+            // A match over nbArms arms starts.
+            constexpr static void enter(size_t /* nbArms */) {}
+            // The pattern of an arm is checked against the value.
+            constexpr static void attempt(size_t /* arm */) {}
+            // The pattern of an arm matched, its handler is invoked.
+            constexpr static void hit(size_t /* arm */) {}
+            // The pattern of an arm mismatched, depth being the deepest level at
+            // which a sub-pattern mismatched, 0 for the pattern itself.
+            constexpr static void miss(size_t /* arm */, int32_t /* depth */) {}
+            // No arm matched.
+            constexpr static void noMatch() {}
+        };
+
+        template <typename Policy>
+        constexpr auto isInstrumentedV = !std::is_same_v<Policy, NoInstrumentation>;
+
         constexpr auto y = 1;
         static_assert(std::holds_alternative<int32_t const *>(
             std::variant<std::monostate, const int32_t *>{&y}));
@@ -594,11 +1366,27 @@ namespace matchit
 
             constexpr static auto nbIdV = PatternTraits<Pattern>::nbIdV;
 
+            template <typename Value>
+            using ProjectionT = Projection<std::decay_t<Unary>, std::remove_reference_t<Value>>;
+
             template <typename Value, typename ContextT>
             constexpr static auto matchPatternImpl(Value &&value,
                                                    App<Unary, Pattern> const &appPat,
                                                    int32_t depth, ContextT &context)
             {
+                if constexpr (isMemoizedV<ContextT, ProjectionT<Value>> &&
+                              std::is_same_v<AppResult<Value>,
+                                             typename ProjectionT<Value>::ResultT>)
+                {
+                    if (!context.inSlot())
+                    {
+                        decltype(auto) result =
+                            context.memo().template slot<ProjectionT<Value>>().project(
+                                appPat.unary(), value);
+                        return matchPattern(std::forward<AppResult<Value>>(result),
+                                            appPat.pattern(), depth + 1, context);
+                    }
+                }
                 if constexpr (std::is_same_v<AppResultCurTuple<Value>, std::tuple<>>)
                 {
                     return matchPattern(
@@ -607,11 +1395,9 @@ namespace matchit
                 }
                 else
                 {
-                    context.emplace_back(invoke_(appPat.unary(), value));
-                    decltype(auto) result =
-                        get<std::decay_t<AppResult<Value>>>(context.back());
-                    return matchPattern(std::forward<AppResult<Value>>(result),
-                                        appPat.pattern(), depth + 1, context);
+                    auto &result = context.emplace_back(invoke_(appPat.unary(), value));
+                    return matchInSlot(std::forward<AppResult<Value>>(result),
+                                       appPat.pattern(), depth + 1, context);
                 }
             }
             constexpr static void processIdImpl(App<Unary, Pattern> const &appPat,
@@ -748,21 +1534,15 @@ namespace matchit
         {
         };
 
+        // Ids of Type refer to values they match by such pointers.
         template <typename Type>
-        using ValueVariant =
-                std::conditional_t<std::is_lvalue_reference_v<Type>,
-                            UniqVariant<std::remove_reference_t<Type>*>,
-                            std::conditional_t<std::is_rvalue_reference_v<Type>,
-                                        UniqVariant<std::remove_reference_t<Type>, std::remove_reference_t<Type> *>,
-                                        std::conditional_t<std::is_abstract_v<std::remove_reference_t<Type>>,
-                                                UniqVariant<std::remove_reference_t<Type>*, std::remove_reference_t<Type> const *>,
-                                                UniqVariant<std::remove_reference_t<Type>, std::remove_reference_t<Type>*, std::remove_reference_t<Type> const *>
-                                                >
-                                            >>;
+        using IdPointerT = std::conditional_t<std::is_reference_v<Type>,
+                                              std::remove_reference_t<Type> *,
+                                              std::remove_reference_t<Type> const *>;
 
         template <typename Type, typename Value>
         struct StorePointer<Type, Value,
-                            std::void_t<decltype(std::declval<ValueVariant<Type> &>() =
+                            std::void_t<decltype(std::declval<IdPointerT<Type> &>() =
                                                      &std::declval<Value>())>>
             : std::is_reference<Value> // need to double check this condition. to loosen it.
         {
@@ -810,25 +1590,94 @@ namespace matchit
             }
         };
 
+        // How an Id is bound to its value.
+        enum class IdBinding : int8_t
+        {
+            kNONE,
+            kPOINTER,
+            kVALUE
+        };
+
+        // The value an Id is bound to: a pointer to the matched value, or the
+        // value moved into the Id when it is an rvalue. Which one is known from
+        // StorePointer when binding, so binding does not dispatch and reading
+        // only checks the tag.
         template <typename Type>
-        class IdBlockBase
+        class IdBlock
         {
-            int32_t mDepth;
-        protected:
-            ValueVariant<Type> mVariant;
+            using ValueT = std::remove_reference_t<Type>;
+            using RefT = std::conditional_t<std::is_rvalue_reference_v<Type>, ValueT &,
+                                            ValueT const &>;
+            // Ids of abstract types can only refer to values.
+            class NoValue
+            {
+            public:
+                constexpr ValueT &operator*() { MATCHIT_FAIL("Invalid state!"); }
+            };
+            using OptionalT = std::conditional_t<std::is_abstract_v<ValueT>, NoValue,
+                                                 std::optional<std::remove_cv_t<ValueT>>>;
+            // Assigning optionals is constexpr for trivial types only. Others
+            // are constructed in place, once and without being assignable.
+            constexpr static auto kASSIGN = std::is_trivially_copyable_v<OptionalT>;
+
+            int32_t mDepth{};
+            IdBinding mBinding{};
+            IdPointerT<Type> mPointer{};
+            OptionalT mValue{};
+            bool mFramed{};
 
         public:
-            constexpr IdBlockBase()
-            : mDepth{}
-            , mVariant{}
-            {}
-
-            constexpr auto &variant() { return mVariant; }
+            // Bound in frames of shared matchers rather than in this block.
+            constexpr bool framed() const { return mFramed; }
+            void share() { mFramed = true; }
+            constexpr bool hasValue() const { return mBinding != IdBinding::kNONE; }
+            constexpr RefT get()
+            {
+                if (mBinding == IdBinding::kPOINTER)
+                {
+                    return *mPointer;
+                }
+                if (mBinding == IdBinding::kNONE)
+                {
+                    MATCHIT_FAIL("Invalid state!");
+                }
+                return *mValue;
+            }
+            template <typename Value>
+            constexpr void bind(Value &&value, std::true_type /* StorePointer */)
+            {
+                mPointer = &value;
+                mBinding = IdBinding::kPOINTER;
+            }
+            template <typename Value>
+            constexpr void bind(Value &&value, std::false_type /* StorePointer */)
+            {
+                if constexpr (kASSIGN)
+                {
+                    mValue = OptionalT{std::forward<Value>(value)};
+                }
+                else
+                {
+                    mValue.emplace(std::forward<Value>(value));
+                }
+                mBinding = IdBinding::kVALUE;
+            }
             constexpr void reset(int32_t depth)
             {
                 if (mDepth - depth >= 0)
                 {
-                    mVariant = {};
+                    if (mBinding == IdBinding::kVALUE)
+                    {
+                        if constexpr (kASSIGN)
+                        {
+                            mValue = OptionalT{};
+                        }
+                        else
+                        {
+                            mValue.reset();
+                        }
+                    }
+                    mBinding = IdBinding::kNONE;
                     mDepth = depth;
                 }
             }
@@ -842,131 +1691,141 @@ namespace matchit
             }
         };
 
-        constexpr IdBlockBase<int> dummy;
-
+        // Ids of references only refer to matched values, rvalues included.
+        // Those borrowed from rvalues live until the handler returns when they
+        // are the matched value, parts of it got by reference, or results of
+        // app patterns.
         template <typename Type>
-        class IdBlock : public IdBlockBase<Type>
+        class IdBlock<Type &>
         {
+            int32_t mDepth{};
+            IdBinding mBinding{};
+            Type *mPointer{};
+            bool mFramed{};
+
         public:
-            constexpr auto hasValue() const
+            constexpr bool framed() const { return mFramed; }
+            void share() { mFramed = true; }
+            constexpr bool hasValue() const { return mBinding != IdBinding::kNONE; }
+            constexpr Type &get()
+            {
+                if (mBinding == IdBinding::kNONE)
+                {
+                    MATCHIT_FAIL("Invalid state!");
+                }
+                return *mPointer;
+            }
+            template <typename Value, bool storePointer>
+            constexpr void bind(Value &&value, std::bool_constant<storePointer>)
+            {
+                mPointer = &value;
+                mBinding = IdBinding::kPOINTER;
+            }
+            constexpr void reset(int32_t depth)
             {
-                return std::visit(overload([](Type const &)
-                                            { return true; },
-                                            [](Type const *)
-                                            { return true; },
-                                            // [](Type *)
-                                            // { return true; },
-                                            [](std::monostate const &)
-                                            { return false; }),
-                                    IdBlockBase<Type>::mVariant);
+                if (mDepth - depth >= 0)
+                {
+                    mBinding = IdBinding::kNONE;
+                    mDepth = depth;
+                }
             }
-            constexpr decltype(auto) get() const
+            constexpr void confirm(int32_t depth)
             {
-                return std::visit(
-                    overload([](Type const &v) -> Type const & { return v; },
-                                [](Type const *p) -> Type const & { return *p; },
-                                [](Type *p) -> Type const & { return *p; },
-                                [](std::monostate const &) -> Type const & {
-                                    throw std::logic_error("invalid state!");
-                                }),
-                    IdBlockBase<Type>::mVariant);
+                if (mDepth > depth || mDepth == 0)
+                {
+                    assert(depth == mDepth - 1 || depth == mDepth || mDepth == 0);
+                    mDepth = depth;
+                }
             }
         };
 
-        template <typename Type>
-        class IdBlock<Type const&> : public IdBlock<Type>
-        {};
-
-        template <typename Type>
-        class IdBlock<Type&> : public IdBlockBase<Type&>
+        // Blocks of the Ids of a shared matcher for one call of it, on the
+        // stack of the call. Frames are chained per thread, so that nested and
+        // recursive calls bind their own Ids, while handlers still read the
+        // Ids of enclosing calls.
+        class IdFrame
         {
-        public:
-            constexpr auto hasValue() const
+            using DestroyT = void (*)(void *);
+
+            IdFrame *mParent;
+            void const **mKeys;
+            DestroyT *mDestroys;
+            unsigned char *mBlocks;
+            size_t mStride;
+            size_t mCapacity;
+            size_t mSize{};
+
+            static IdFrame *&current()
             {
-                return std::visit(overload([](Type *)
-                                           { return true; },
-                                           [](std::monostate const &)
-                                           { return false; }),
-                                    IdBlockBase<Type&>::mVariant);
+                thread_local IdFrame *frame = nullptr;
+                return frame;
             }
 
-            constexpr decltype(auto) get()
+            template <typename BlockT>
+            static void destroy(void *block)
             {
-                return std::visit(
-                    overload(
-                        [](Type * v) -> Type &
-                        {
-                            if (v == nullptr)
-                            {
-                                throw std::logic_error(
-                                    "Trying to dereference a nullptr!");
-                            }
-                            return *v;
-                        },
-                        [](std::monostate &) -> Type &
-                        {
-                            throw std::logic_error("Invalid state!");
-                        }),
-                    IdBlockBase<Type&>::mVariant);
+                static_cast<BlockT *>(block)->~BlockT();
             }
-        };
 
-        template <typename Type>
-        class IdBlock<Type&&> : public IdBlockBase<Type&&>
-        {
-        public:
-            constexpr auto hasValue() const
+        protected:
+            IdFrame(void const **keys, DestroyT *destroys, unsigned char *blocks,
+                    size_t stride, size_t capacity)
+                : mParent{current()}, mKeys{keys}, mDestroys{destroys}, mBlocks{blocks},
+                  mStride{stride}, mCapacity{capacity}
             {
-                return std::visit(overload([](Type const &)
-                                            { return true; },
-                                            [](Type *)
-                                            { return true; },
-                                            [](std::monostate const &)
-                                            { return false; }),
-                                    IdBlockBase<Type&&>::mVariant);
+                current() = this;
             }
-
-            constexpr decltype(auto) get()
+            ~IdFrame()
             {
-                return std::visit(
-                    overload(
-                        [](Type &v) -> Type &
-                        {
-                            return v;
-                        },
-                        [](Type * v) -> Type &
-                        {
-                            if (v == nullptr)
-                            {
-                                throw std::logic_error(
-                                    "Trying to dereference a nullptr!");
-                            }
-                            return *v;
-                        },
-                        [](std::monostate &) -> Type &
-                        {
-                            throw std::logic_error("Invalid state!");
-                        }),
-                    IdBlockBase<Type&&>::mVariant);
+                for (size_t i = mSize; i > 0; --i)
+                {
+                    mDestroys[i - 1](mBlocks + (i - 1) * mStride);
+                }
+                current() = mParent;
             }
-        };
 
-        template <typename Type>
-        class IdUtil
-        {
         public:
-            template <typename Value>
-            constexpr static auto bindValue(ValueVariant<Type> &v, Value &&value,
-                                                    std::false_type /* StorePointer */)
+            IdFrame(IdFrame const &) = delete;
+            IdFrame &operator=(IdFrame const &) = delete;
+
+            // Gives the Id sharing the block key an unbound block in the
+            // innermost frame.
+            template <typename BlockT>
+            static void claim(void const *key)
             {
-                // for constexpr
-                v = ValueVariant<Type>{std::forward<Value>(value)};
+                auto &frame = *current();
+                for (size_t i = 0; i < frame.mSize; ++i)
+                {
+                    if (frame.mKeys[i] == key)
+                    {
+                        return;
+                    }
+                }
+                if (frame.mSize == frame.mCapacity)
+                {
+                    MATCHIT_FAIL("Too many Ids for the frame!");
+                }
+                ::new (static_cast<void *>(frame.mBlocks + frame.mSize * frame.mStride)) BlockT{};
+                frame.mKeys[frame.mSize] = key;
+                frame.mDestroys[frame.mSize] = &destroy<BlockT>;
+                ++frame.mSize;
             }
-            template <typename Value>
-            constexpr static auto bindValue(ValueVariant<Type> &v, Value &&value,
-                                                    std::true_type /* StorePointer */)
+
+            // The block of the Id sharing the block key in the innermost frame
+            // holding one, or nullptr.
+            static void *find(void const *key)
             {
-                v = ValueVariant<Type>{&value};
+                for (auto *frame = current(); frame != nullptr; frame = frame->mParent)
+                {
+                    for (size_t i = 0; i < frame->mSize; ++i)
+                    {
+                        if (frame->mKeys[i] == key)
+                        {
+                            return frame->mBlocks + i * frame->mStride;
+                        }
+                    }
+                }
+                return nullptr;
             }
         };
 
@@ -975,15 +1834,16 @@ namespace matchit
         {
         private:
             using BlockT = IdBlock<Type>;
-            using BlockVT = std::variant<BlockT, BlockT *>;
-            BlockVT mBlock = BlockT{};
+            BlockT mBlock{};
+            // Copies of an Id share the block of the original one.
+            BlockT *mShared = &mBlock;
 
             constexpr decltype(auto) internalValue() const { return block().get(); }
 
         public:
             constexpr Id() = default;
 
-            constexpr Id(Id const &id) { mBlock = BlockVT{&id.block()}; }
+            constexpr Id(Id const &id) : mShared{id.mShared} {}
 
             // non-const to inform users not to mark Id as const.
             template <typename Pattern>
@@ -997,11 +1857,18 @@ namespace matchit
 
             constexpr BlockT &block() const
             {
-                return std::visit(overload([](BlockT &v) -> BlockT & { return v; },
-                                           [](BlockT *p) -> BlockT & { return *p; }),
-                                  // constexpr does not allow mutable, we use const_cast
-                                  // instead. Never declare Id as const.
-                                  const_cast<BlockVT &>(mBlock));
+                if (mShared->framed())
+                {
+                    return framedBlock();
+                }
+                return *mShared;
+            }
+            // Ids used outside of calls to their shared matchers fall back to
+            // their own block.
+            BlockT &framedBlock() const
+            {
+                auto *const block = IdFrame::find(mShared);
+                return block == nullptr ? *mShared : *std::launder(static_cast<BlockT *>(block));
             }
 
             template <typename Value>
@@ -1012,13 +1879,14 @@ namespace matchit
                 {
                     return IdTraits<std::decay_t<Type>>::equal(internalValue(), v);
                 }
-                IdUtil<Type>::bindValue(block().variant(), std::forward<Value>(v),
-                                   StorePointer<Type, Value>{});
+                block().bind(std::forward<Value>(v), StorePointer<Type, Value>{});
                 return true;
             }
             constexpr void reset(int32_t depth) const { return block().reset(depth); }
             constexpr void confirm(int32_t depth) const { return block().confirm(depth); }
             constexpr bool hasValue() const { return block().hasValue(); }
+            void share() const { mShared->share(); }
+            void frame() const { IdFrame::claim<BlockT>(mShared); }
             // non-const to inform users not to mark Id as const.
             constexpr decltype(auto) get() { return block().get(); }
             // non-const to inform users not to mark Id as const.
@@ -1052,6 +1920,14 @@ namespace matchit
                 case IdProcess::kCONFIRM:
                     idPat.confirm(depth);
                     break;
+
+                case IdProcess::kSHARE:
+                    idPat.share();
+                    break;
+
+                case IdProcess::kFRAME:
+                    idPat.frame();
+                    break;
                 }
             }
         };
@@ -1075,48 +1951,145 @@ namespace matchit
             return Ds<Patterns...>{patterns...};
         }
 
+        // Captures the value it is matched against, which is then passed to
+        // the handler, e.g. pattern | ds(capture<int>, _) = [](int i) { ... }.
+        // capture<T &> refers to the value, others copy it.
         template <typename T>
-        class OooBinder
-        {
-            Id<T> mId;
-
-        public:
-            OooBinder(Id<T> const &id) : mId{id} {}
-            decltype(auto) binder() const { return mId; }
-        };
-
-        class Ooo
+        class Capture
         {
-        public:
-            template <typename T>
-            constexpr auto operator()(Id<T> id) const
-            {
-                return OooBinder<T>{id};
-            }
         };
 
-        constexpr Ooo ooo;
+        template <typename T>
+        constexpr Capture<T> capture{};
 
-        template <>
-        class PatternTraits<Ooo>
+        template <typename T>
+        class PatternTraits<Capture<T>>
         {
+            using SlotT = std::conditional_t<std::is_reference_v<T>,
+                                             std::remove_reference_t<T> *, T>;
+
         public:
             template <typename Value>
-            using AppResultTuple = std::tuple<>;
+            using AppResultTuple = std::tuple<SlotT>;
 
             constexpr static auto nbIdV = false;
 
             template <typename Value, typename ContextT>
-            constexpr static auto matchPatternImpl(Value &&, Ooo, int32_t /*depth*/,
-                                                   ContextT &)
+            constexpr static auto matchPatternImpl(Value &&value, Capture<T> const &,
+                                                   int32_t /* depth */, ContextT &context)
             {
+                SlotT slot = [&]() -> SlotT
+                {
+                    if constexpr (std::is_reference_v<T>)
+                    {
+                        return &value;
+                    }
+                    else
+                    {
+                        return std::forward<Value>(value);
+                    }
+                }();
+                context.capture(std::move(slot));
                 return true;
             }
-            constexpr static void processIdImpl(Ooo, int32_t /*depth*/, IdProcess) {}
+            constexpr static void processIdImpl(Capture<T> const &, int32_t /*depth*/,
+                                                IdProcess)
+            {
+            }
         };
 
-        template <typename Pattern>
-        class PatternTraits<OooBinder<Pattern>>
+        template <typename T>
+        class CaptureTuple<Capture<T>>
+        {
+        public:
+            using type = std::tuple<T>;
+        };
+
+        template <typename Unary, typename Pattern>
+        class CaptureTuple<App<Unary, Pattern>> : public CaptureTuple<Pattern>
+        {
+        };
+
+        template <typename Pattern, typename Pred>
+        class CaptureTuple<PostCheck<Pattern, Pred>> : public CaptureTuple<Pattern>
+        {
+        };
+
+        template <typename... Patterns>
+        class CaptureTuple<And<Patterns...>>
+        {
+        public:
+            using type = decltype(std::tuple_cat(std::declval<CaptureTupleT<Patterns>>()...));
+        };
+
+        template <typename... Patterns>
+        class CaptureTuple<Ds<Patterns...>> : public CaptureTuple<And<Patterns...>>
+        {
+        };
+
+        // Only some alternatives match, so they can not capture.
+        template <typename... Patterns>
+        class CaptureTuple<Or<Patterns...>>
+        {
+            static_assert(((std::tuple_size_v<CaptureTupleT<Patterns>> == 0) && ...),
+                          "capture<T> can not be used within or_.");
+
+        public:
+            using type = std::tuple<>;
+        };
+
+        template <typename Pattern>
+        class CaptureTuple<Not<Pattern>>
+        {
+            static_assert(std::tuple_size_v<CaptureTupleT<Pattern>> == 0,
+                          "capture<T> can not be used within not_.");
+
+        public:
+            using type = std::tuple<>;
+        };
+
+        template <typename T>
+        class OooBinder
+        {
+            Id<T> mId;
+
+        public:
+            OooBinder(Id<T> const &id) : mId{id} {}
+            decltype(auto) binder() const { return mId; }
+        };
+
+        class Ooo
+        {
+        public:
+            template <typename T>
+            constexpr auto operator()(Id<T> id) const
+            {
+                return OooBinder<T>{id};
+            }
+        };
+
+        constexpr Ooo ooo;
+
+        template <>
+        class PatternTraits<Ooo>
+        {
+        public:
+            template <typename Value>
+            using AppResultTuple = std::tuple<>;
+
+            constexpr static auto nbIdV = false;
+
+            template <typename Value, typename ContextT>
+            constexpr static auto matchPatternImpl(Value &&, Ooo, int32_t /*depth*/,
+                                                   ContextT &)
+            {
+                return true;
+            }
+            constexpr static void processIdImpl(Ooo, int32_t /*depth*/, IdProcess) {}
+        };
+
+        template <typename Pattern>
+        class PatternTraits<OooBinder<Pattern>>
         {
         public:
             template <typename Value>
@@ -1227,34 +2200,108 @@ namespace matchit
                 std::make_index_sequence<size>{});
         }
 
-        template <std::size_t patternStartIdx, std::size_t... I, typename RangeBegin,
-                  typename PatternTuple, typename ContextT>
-        constexpr decltype(auto) matchPatternRangeImpl(RangeBegin &&rangeBegin,
-                                                       PatternTuple &&patternTuple,
-                                                       int32_t depth, ContextT &context,
-                                                       std::index_sequence<I...>)
+        // Matches the patterns from patternStartIdx on against the elements
+        // from it on, advancing it past each of them once. Unless bounded,
+        // i.e. the elements are known to suffice, running out of them fails.
+        template <std::size_t patternStartIdx, bool bounded, std::size_t... I, typename Iter,
+                  typename Sentinel, typename PatternTuple, typename ContextT>
+        constexpr bool matchPatternRangeImpl(Iter &it, Sentinel const &end,
+                                             PatternTuple &&patternTuple, int32_t depth,
+                                             ContextT &context, std::index_sequence<I...>)
         {
-            auto const func = [&](auto &&value, auto &&pattern)
+            auto const func = [&](auto &&pattern)
             {
-                return matchPattern(std::forward<decltype(value)>(value), pattern,
-                                    depth + 1, context);
+                if constexpr (!bounded)
+                {
+                    if (it == end)
+                    {
+                        return false;
+                    }
+                }
+                auto const matched = matchPattern(*it, pattern, depth + 1, context);
+                ++it;
+                return matched;
             };
             static_cast<void>(func);
-            // Fix Me, avoid call next from begin every time.
-            return (func(*std::next(rangeBegin, static_cast<long>(I)),
-                         std::get<I + patternStartIdx>(patternTuple)) &&
-                    ...);
+            static_cast<void>(end);
+            return (func(std::get<I + patternStartIdx>(patternTuple)) && ...);
         }
 
-        template <std::size_t patternStartIdx, std::size_t size,
-                  typename ValueRangeBegin, typename PatternTuple, typename ContextT>
-        constexpr decltype(auto) matchPatternRange(ValueRangeBegin &&valueRangeBegin,
-                                                   PatternTuple &&patternTuple,
-                                                   int32_t depth, ContextT &context)
+        template <std::size_t patternStartIdx, std::size_t size, bool bounded, typename Iter,
+                  typename Sentinel, typename PatternTuple, typename ContextT>
+        constexpr bool matchPatternRange(Iter &it, Sentinel const &end,
+                                         PatternTuple &&patternTuple, int32_t depth,
+                                         ContextT &context)
         {
-            return matchPatternRangeImpl<patternStartIdx>(
-                valueRangeBegin, patternTuple, depth, context,
-                std::make_index_sequence<size>{});
+            return matchPatternRangeImpl<patternStartIdx, bounded>(
+                it, end, patternTuple, depth, context, std::make_index_sequence<size>{});
+        }
+
+        template <typename Iter, typename Tag>
+        constexpr auto iteratorIsV = std::is_base_of_v<
+            Tag, typename std::iterator_traits<std::decay_t<Iter>>::iterator_category>;
+
+        template <typename Range, typename = void>
+        constexpr bool hasDataV = false;
+
+        template <typename Range>
+        constexpr bool
+            hasDataV<Range, std::void_t<decltype(std::data(std::declval<Range const &>()))>> =
+                true;
+
+        // The end of the elements left for ooo, from its begin on, when size
+        // elements follow it, or nothing when fewer elements are left.
+        // Forward iterators walk the range once, with a lead of size.
+        template <std::size_t size, typename Iter, typename Sentinel>
+        constexpr std::optional<Iter> oooEnd(Iter const &beginOoo, Sentinel const &end)
+        {
+            constexpr auto isIter = std::is_same_v<Iter, Sentinel>;
+            if constexpr (size == 0 && isIter)
+            {
+                static_cast<void>(beginOoo);
+                return end;
+            }
+            else if constexpr (iteratorIsV<Iter, std::random_access_iterator_tag> && isIter)
+            {
+                if (end - beginOoo < static_cast<std::ptrdiff_t>(size))
+                {
+                    return {};
+                }
+                return end - static_cast<std::ptrdiff_t>(size);
+            }
+            else if constexpr (iteratorIsV<Iter, std::bidirectional_iterator_tag> && isIter)
+            {
+                auto endOoo = end;
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (endOoo == beginOoo)
+                    {
+                        return {};
+                    }
+                    --endOoo;
+                }
+                return endOoo;
+            }
+            else
+            {
+                static_assert(size == 0 || iteratorIsV<Iter, std::forward_iterator_tag>,
+                              "Patterns after ooo need ranges of forward iterators.");
+                auto lead = beginOoo;
+                for (size_t i = 0; i < size; ++i)
+                {
+                    if (lead == end)
+                    {
+                        return {};
+                    }
+                    ++lead;
+                }
+                auto endOoo = beginOoo;
+                for (; lead != end; ++lead)
+                {
+                    ++endOoo;
+                }
+                return endOoo;
+            }
         }
 
         template <std::size_t start, typename Indices, typename Tuple>
@@ -1354,7 +2401,27 @@ namespace matchit
         class PatternTraits<Ds<Patterns...>>
         {
             constexpr static auto nbOooOrBinder = nbOooOrBinderV<Patterns...>;
-            static_assert(nbOooOrBinder == 0 || nbOooOrBinder == 1);
+            constexpr static auto nbPat = sizeof...(Patterns);
+
+            // The positions of the ooo patterns, then nbPat.
+            constexpr static auto oooIdxs()
+            {
+                constexpr bool isOoo[] = {isOooOrBinderV<Patterns>..., true};
+                std::array<size_t, nbOooOrBinder + 1> idxs{};
+                size_t k = 0;
+                for (size_t i = 0; i <= nbPat; ++i)
+                {
+                    if (isOoo[i])
+                    {
+                        idxs[k++] = i;
+                    }
+                }
+                return idxs;
+            }
+
+            template <size_t idx>
+            constexpr static auto isBinderAt =
+                isOooBinderV<std::tuple_element_t<idx, std::tuple<Patterns...>>>;
 
         public:
             template <typename PsTuple, typename VsTuple>
@@ -1370,7 +2437,13 @@ namespace matchit
             };
 
             template <std::size_t nbOoos, typename ValueTuple>
-            class AppResultForTupleHelper;
+            class AppResultForTupleHelper
+            {
+                static_assert(nbOoos <= 1, "Only one ooo is allowed when destructuring tuples.");
+
+            public:
+                using type = std::tuple<>;
+            };
 
             template <typename... Values>
             class AppResultForTupleHelper<0, std::tuple<Values...>>
@@ -1417,10 +2490,14 @@ namespace matchit
             using AppResultForTuple = typename AppResultForTupleHelper<
                 nbOooOrBinder, decltype(drop<0>(std::declval<Tuple>()))>::type;
 
+            template <typename RangeType, size_t... I>
+            static auto rangeTuple(std::index_sequence<I...>)
+                -> std::tuple<std::conditional_t<I == I, SubrangeT<RangeType>, void>...>;
+
+            // A subrange for each ooo.
             template <typename RangeType>
             using RangeTuple =
-                std::conditional_t<nbOooOrBinder == 1, std::tuple<SubrangeT<RangeType>>,
-                                   std::tuple<>>;
+                decltype(rangeTuple<RangeType>(std::make_index_sequence<nbOooOrBinder>{}));
 
             template <typename RangeType>
             using AppResultForRangeType = decltype(std::tuple_cat(
@@ -1490,13 +2567,11 @@ namespace matchit
                         if constexpr (isBinder)
                         {
                             auto const rangeSize = static_cast<long>(valLen - (patLen - 1));
-                            context.emplace_back(makeSubrange(&valueTuple[idxOoo],
-                                                              &valueTuple[idxOoo] + rangeSize));
-                            using type = decltype(makeSubrange(&valueTuple[idxOoo],
-                                                               &valueTuple[idxOoo] + rangeSize));
-                            result = result && matchPattern(std::get<type>(context.back()),
-                                                            std::get<idxOoo>(dsPat.patterns()),
-                                                            depth, context);
+                            auto &subrange = context.emplace_back(makeSubrange(
+                                &valueTuple[idxOoo], &valueTuple[idxOoo] + rangeSize));
+                            result = result && matchInSlot(subrange,
+                                                           std::get<idxOoo>(dsPat.patterns()),
+                                                           depth, context);
                         }
                     }
                     else
@@ -1517,50 +2592,271 @@ namespace matchit
                 -> std::enable_if_t<!isTupleLikeV<ValueRange> && isRangeV<ValueRange>,
                                     bool>
             {
-                static_assert(nbOooOrBinder == 0 || nbOooOrBinder == 1);
-                constexpr auto nbPat = sizeof...(Patterns);
+                auto it = std::begin(valueRange);
+                auto const end = std::end(valueRange);
+                // Random access ranges are measured once, others are walked
+                // once, so that they need no size().
+                constexpr auto isRandomAccess =
+                    iteratorIsV<decltype(it), std::random_access_iterator_tag> &&
+                    std::is_same_v<decltype(it), std::remove_const_t<decltype(end)>>;
 
                 if constexpr (nbOooOrBinder == 0)
                 {
-                    // size mismatch for dynamic array is not an error;
-                    if (valueRange.size() != nbPat)
+                    if constexpr (isRandomAccess)
                     {
-                        return false;
+                        // size mismatch for dynamic array is not an error;
+                        if (end - it != static_cast<std::ptrdiff_t>(nbPat))
+                        {
+                            return false;
+                        }
+                        return matchPatternRange<0, nbPat, true>(it, end, dsPat.patterns(),
+                                                                 depth, context);
+                    }
+                    else
+                    {
+                        return matchPatternRange<0, nbPat, false>(it, end, dsPat.patterns(),
+                                                                  depth, context) &&
+                               it == end;
                     }
-                    return matchPatternRange<0, nbPat>(std::begin(valueRange),
-                                                       dsPat.patterns(), depth, context);
                 }
                 else if constexpr (nbOooOrBinder == 1)
                 {
-                    if (valueRange.size() < nbPat - 1)
-                    {
-                        return false;
-                    }
                     constexpr auto idxOoo = findOooIdx<typename Ds<Patterns...>::Type>();
                     constexpr auto isBinder =
                         isOooBinderV<std::tuple_element_t<idxOoo, std::tuple<Patterns...>>>;
-                    auto result = matchPatternRange<0, idxOoo>(
-                        std::begin(valueRange), dsPat.patterns(), depth, context);
-                    auto const valLen = valueRange.size();
-                    constexpr auto patLen = sizeof...(Patterns);
-                    auto const beginOoo = std::next(std::begin(valueRange), idxOoo);
+                    constexpr auto nbAfterOoo = nbPat - idxOoo - 1;
+                    if constexpr (isRandomAccess)
+                    {
+                        if (end - it < static_cast<std::ptrdiff_t>(nbPat - 1))
+                        {
+                            return false;
+                        }
+                    }
+                    auto result = matchPatternRange<0, idxOoo, isRandomAccess>(
+                        it, end, dsPat.patterns(), depth, context);
+                    // Nothing after an unbound ooo is read.
+                    if (!result || (nbAfterOoo == 0 && !isBinder))
+                    {
+                        return result;
+                    }
+                    auto const beginOoo = it;
+                    auto const endOoo = oooEnd<nbAfterOoo>(beginOoo, end);
+                    if (!endOoo)
+                    {
+                        return false;
+                    }
                     if constexpr (isBinder)
                     {
-                        auto const rangeSize = static_cast<long>(valLen - (patLen - 1));
-                        auto const end = std::next(beginOoo, rangeSize);
-                        context.emplace_back(makeSubrange(beginOoo, end));
-                        using type = decltype(makeSubrange(beginOoo, end));
-                        result = result && matchPattern(std::get<type>(context.back()),
-                                                        std::get<idxOoo>(dsPat.patterns()),
-                                                        depth, context);
+                        auto &subrange = context.emplace_back(makeSubrange(beginOoo, *endOoo));
+                        result = matchInSlot(subrange, std::get<idxOoo>(dsPat.patterns()),
+                                             depth, context);
+                    }
+                    auto beginAfterOoo = *endOoo;
+                    return result && matchPatternRange<idxOoo + 1, nbAfterOoo, true>(
+                                         beginAfterOoo, end, dsPat.patterns(), depth, context);
+                }
+                else
+                {
+                    // The patterns before the first ooo are matched at the
+                    // begin, those after the last one at the end, and those
+                    // between two ooo where they match first.
+                    static_assert(iteratorIsV<decltype(it), std::forward_iterator_tag>,
+                                  "Many ooo need ranges of forward iterators.");
+                    constexpr auto idxs = oooIdxs();
+                    constexpr auto nbAfterLast = nbPat - idxs[nbOooOrBinder - 1] - 1;
+                    if (!matchPatternRange<0, idxs[0], false>(it, end, dsPat.patterns(), depth,
+                                                               context))
+                    {
+                        return false;
+                    }
+                    auto const tail = oooEnd<nbAfterLast>(it, end);
+                    if (!tail)
+                    {
+                        return false;
+                    }
+                    auto afterLast = *tail;
+                    return matchPatternRange<idxs[nbOooOrBinder - 1] + 1, nbAfterLast, true>(
+                               afterLast, end, dsPat.patterns(), depth, context) &&
+                           matchSegments<0>(valueRange, it, *tail, dsPat, depth, context);
+                }
+            }
+
+            // Binds the ooo at idx to the elements from begin to end.
+            template <size_t idx, typename Iter, typename ContextT>
+            constexpr static bool bindOoo(Iter const &begin, Iter const &end,
+                                          Ds<Patterns...> const &dsPat, int32_t depth,
+                                          ContextT &context)
+            {
+                if constexpr (isBinderAt<idx>)
+                {
+                    auto &subrange = context.emplace_back(makeSubrange(begin, end));
+                    return matchInSlot(subrange, std::get<idx>(dsPat.patterns()), depth,
+                                       context);
+                }
+                else
+                {
+                    static_cast<void>(begin);
+                    static_cast<void>(end);
+                    static_cast<void>(dsPat);
+                    static_cast<void>(depth);
+                    static_cast<void>(context);
+                    return true;
+                }
+            }
+
+            // Matches the patterns between the k-th ooo and the next one where
+            // they first match from it on, before last, and binds the ooo.
+            template <size_t k, typename ValueRange, typename Iter, typename ContextT>
+            constexpr static bool matchSegments(ValueRange const &valueRange, Iter const &it,
+                                                Iter const &last, Ds<Patterns...> const &dsPat,
+                                                int32_t depth, ContextT &context)
+            {
+                constexpr auto idxs = oooIdxs();
+                if constexpr (k + 1 == nbOooOrBinder)
+                {
+                    static_cast<void>(valueRange);
+                    return bindOoo<idxs[k]>(it, last, dsPat, depth, context);
+                }
+                else
+                {
+                    constexpr auto first = idxs[k] + 1;
+                    constexpr auto size = idxs[k + 1] - first;
+                    auto const found = findSegment<first, size>(valueRange, it, last, dsPat,
+                                                                depth, context);
+                    return found &&
+                           bindOoo<idxs[k]>(it, found->first, dsPat, depth, context) &&
+                           matchSegments<k + 1>(valueRange, found->second, last, dsPat, depth,
+                                                context);
+                }
+            }
+
+            // Whether the patterns from first on are values of the element
+            // type, to be searched for instead of matched at each position.
+            template <size_t first, typename ElemT, size_t... I>
+            constexpr static bool isLiteralSegment(std::index_sequence<I...>)
+            {
+                return (std::is_integral_v<ElemT> || std::is_enum_v<ElemT>) &&
+                       (std::is_same_v<
+                            InternalPatternT<
+                                std::tuple_element_t<first + I, std::tuple<Patterns...>>>,
+                            ElemT> &&
+                        ...);
+            }
+
+            // The first position of needle from it on, before last, or last.
+            template <typename ValueRange, typename Iter, typename ElemT, size_t size>
+            static Iter searchSegment(ValueRange const &valueRange, Iter const &it,
+                                      Iter const &last, std::array<ElemT, size> const &needle)
+            {
+                if constexpr (iteratorIsV<Iter, std::random_access_iterator_tag> &&
+                              hasDataV<ValueRange> && sizeof(ElemT) == 1)
+                {
+                    // Contiguous bytes: scan for the first one, then compare.
+                    auto const data = std::data(valueRange);
+                    static_assert(std::is_same_v<std::decay_t<decltype(*data)>, ElemT>);
+                    auto const base = std::begin(valueRange);
+                    auto const from = data + (it - base);
+                    auto const to = data + (last - base);
+                    if constexpr (size >= 8)
+                    {
+                        auto const found = std::search(
+                            from, to,
+                            std::boyer_moore_horspool_searcher(needle.begin(), needle.end()));
+                        return it + (found - from);
+                    }
+                    else
+                    {
+                        auto const first = static_cast<unsigned char>(needle[0]);
+                        for (auto pos = from; to - pos >= static_cast<std::ptrdiff_t>(size);)
+                        {
+                            auto const hit = static_cast<std::decay_t<decltype(data)>>(
+                                std::memchr(pos, first,
+                                            static_cast<size_t>(to - pos) - size + 1));
+                            if (hit == nullptr)
+                            {
+                                break;
+                            }
+                            if (std::memcmp(hit + 1, needle.data() + 1, size - 1) == 0)
+                            {
+                                return it + (hit - from);
+                            }
+                            pos = hit + 1;
+                        }
+                        return last;
+                    }
+                }
+                else
+                {
+                    static_cast<void>(valueRange);
+                    return std::search(it, last, needle.begin(), needle.end());
+                }
+            }
+
+            // Where the patterns from first on match first from it on, before
+            // last, as the begin and end of the elements they match.
+            template <size_t first, size_t size, typename ValueRange, typename Iter,
+                      typename ContextT>
+            constexpr static std::optional<std::pair<Iter, Iter>>
+            findSegment(ValueRange const &valueRange, Iter const &it, Iter const &last,
+                        Ds<Patterns...> const &dsPat, int32_t depth, ContextT &context)
+            {
+                using ElemT = typename std::iterator_traits<Iter>::value_type;
+                constexpr auto isLiteral =
+                    size > 0 && isLiteralSegment<first, ElemT>(std::make_index_sequence<size>{});
+                if constexpr (isLiteral)
+                {
+                    auto const needle = segmentValues<first, ElemT>(
+                        dsPat, std::make_index_sequence<size>{});
+                    auto const begin = searchSegment(valueRange, it, last, needle);
+                    if (begin == last)
+                    {
+                        return {};
+                    }
+                    return std::make_pair(begin, std::next(begin, static_cast<long>(size)));
+                }
+                else
+                {
+                    static_cast<void>(valueRange);
+                    for (auto begin = it;; ++begin)
+                    {
+                        auto const mark = context.mark();
+                        auto end = begin;
+                        if (matchPatternRange<first, size, false>(end, last, dsPat.patterns(),
+                                                                  depth, context))
+                        {
+                            return std::make_pair(begin, end);
+                        }
+                        context.restore(mark);
+                        cancelSegment<first>(dsPat, depth,
+                                             std::make_index_sequence<size>{});
+                        if (begin == last)
+                        {
+                            return {};
+                        }
                     }
-                    auto const beginAfterOoo =
-                        std::next(beginOoo, static_cast<long>(valLen - patLen + 1));
-                    return result && matchPatternRange<idxOoo + 1, patLen - idxOoo - 1>(
-                                         beginAfterOoo, dsPat.patterns(), depth, context);
                 }
             }
 
+            // Unbinds the Ids of the patterns from first on after they failed
+            // to match where they were tried.
+            template <size_t first, size_t... I>
+            constexpr static void cancelSegment(Ds<Patterns...> const &dsPat, int32_t depth,
+                                                std::index_sequence<I...>)
+            {
+                static_cast<void>(dsPat);
+                static_cast<void>(depth);
+                (processId(std::get<first + I>(dsPat.patterns()), depth + 1,
+                           IdProcess::kCANCEL),
+                 ...);
+            }
+
+            template <size_t first, typename ElemT, size_t... I>
+            constexpr static auto segmentValues(Ds<Patterns...> const &dsPat,
+                                                std::index_sequence<I...>)
+            {
+                return std::array<ElemT, sizeof...(I)>{std::get<first + I>(dsPat.patterns())...};
+            }
+
             constexpr static void processIdImpl(Ds<Patterns...> const &dsPat,
                                                 int32_t depth, IdProcess idProcess)
             {
@@ -1657,70 +2953,2608 @@ namespace matchit
         static_assert(PatternTraits<Or<Id<int32_t>, Id<float>>>::nbIdV == 2);
         static_assert(PatternTraits<Or<Wildcard, float>>::nbIdV == 0);
 
-        template <typename Value, typename... PatternPairs>
-        constexpr auto matchPatterns(Value &&value, PatternPairs const &...patterns)
+        // Projections done by a pattern, memoized when shared by several arms.
+        template <typename Pattern, typename Value>
+        class Projections
         {
-            using RetType = typename PatternPairsRetType<PatternPairs...>::RetType;
-            using TypeTuple = decltype(std::tuple_cat(
-                std::declval<typename PatternTraits<typename PatternPairs::PatternT>::
-                                 template AppResultTuple<Value>>()...));
+        public:
+            using type = std::tuple<>;
+        };
 
-            // expression, has return value.
-            if constexpr (!std::is_same_v<RetType, void>)
-            {
-                constexpr auto const func =
-                    [](auto const &pattern, auto &&value, RetType &result) constexpr->bool
-                {
-                    auto context = typename ContextTrait<TypeTuple>::ContextT{};
-                    if (pattern.matchValue(std::forward<Value>(value), context))
-                    {
-                        result = pattern.execute();
-                        processId(pattern, 0, IdProcess::kCANCEL);
-                        return true;
-                    }
-                    return false;
-                };
-                RetType result{};
-                bool const matched = (func(patterns, value, result) || ...);
-                if (!matched)
-                {
-                    throw std::logic_error{"Error: no patterns got matched!"};
-                }
-                static_cast<void>(matched);
-                return result;
-            }
-            else
-            // statement, no return value, mismatching all patterns is not an error.
-            {
-                auto const func = [](auto const &pattern, auto &&value) -> bool
-                {
-                    auto context = typename ContextTrait<TypeTuple>::ContextT{};
-                    if (pattern.matchValue(std::forward<Value>(value), context))
-                    {
-                        pattern.execute();
-                        processId(pattern, 0, IdProcess::kCANCEL);
-                        return true;
-                    }
-                    return false;
-                };
-                bool const matched = (func(patterns, value) || ...);
-                static_cast<void>(matched);
-            }
+        template <typename Pattern, typename Value>
+        using ProjectionsT = typename Projections<Pattern, Value>::type;
+
+        template <typename Unary, typename Pattern, typename Value>
+        class Projections<App<Unary, Pattern>, Value>
+        {
+            using Traits = PatternTraits<App<Unary, Pattern>>;
+            using Key = typename Traits::template ProjectionT<Value>;
+            using AppResult = typename Traits::template AppResult<Value>;
+            using CurTuple = std::conditional_t<
+                Key::memoizable && std::is_same_v<AppResult, typename Key::ResultT>,
+                std::tuple<Key>, std::tuple<>>;
+
+        public:
+            using type = decltype(std::tuple_cat(
+                std::declval<CurTuple>(), std::declval<ProjectionsT<Pattern, AppResult>>()));
+        };
+
+        template <typename... Patterns, typename Value>
+        class Projections<And<Patterns...>, Value>
+        {
+        public:
+            using type =
+                decltype(std::tuple_cat(std::declval<ProjectionsT<Patterns, Value>>()...));
+        };
+
+        template <typename... Patterns, typename Value>
+        class Projections<Or<Patterns...>, Value>
+        {
+        public:
+            using type =
+                decltype(std::tuple_cat(std::declval<ProjectionsT<Patterns, Value>>()...));
+        };
+
+        template <typename Pattern, typename Value>
+        class Projections<Not<Pattern>, Value>
+        {
+        public:
+            using type = ProjectionsT<Pattern, Value>;
+        };
+
+        template <typename Pattern, typename Pred, typename Value>
+        class Projections<PostCheck<Pattern, Pred>, Value>
+        {
+        public:
+            using type = ProjectionsT<Pattern, Value>;
+        };
+
+        template <typename T, typename Tuple>
+        class Count;
+
+        template <typename T, typename... Ts>
+        class Count<T, std::tuple<Ts...>>
+        {
+        public:
+            constexpr static auto value =
+                (static_cast<size_t>(std::is_same_v<T, Ts>) + ... + size_t{0});
+        };
+
+        template <typename All, typename Keys>
+        class SharedMemo;
+
+        template <typename All, typename... Keys>
+        class SharedMemo<All, std::tuple<Keys...>>
+        {
+            template <typename... Shared>
+            static auto toMemo(std::tuple<Shared...>) -> Memo<Shared...>;
+
+        public:
+            using type = decltype(toMemo(std::tuple_cat(
+                std::declval<std::conditional_t<(Count<Keys, All>::value > 1),
+                                                std::tuple<Keys>, std::tuple<>>>()...)));
+        };
+
+        // Memo of projections shared by at least two arms or twice in one arm.
+        template <typename Value, typename... PatternPairs>
+        using MemoT = typename SharedMemo<
+            decltype(std::tuple_cat(
+                std::declval<ProjectionsT<typename PatternPairs::PatternT, Value>>()...)),
+            typename Unique<decltype(std::tuple_cat(
+                std::declval<ProjectionsT<typename PatternPairs::PatternT, Value>>()...))>::
+                type>::type;
+
+        template <typename ContextT, bool instrumented = false, typename MemoT>
+        constexpr auto makeContext(MemoT &memo)
+        {
+            if constexpr (std::is_same_v<MemoT, Memo<>>)
+            {
+                static_cast<void>(memo);
+                return std::conditional_t<instrumented, InstrumentedContext<ContextT>,
+                                          ContextT>{};
+            }
+            else
+            {
+                using SharedContextT = SharedContext<ContextT, MemoT>;
+                return std::conditional_t<instrumented, InstrumentedContext<SharedContextT>,
+                                          SharedContextT>{memo};
+            }
+        }
+
+        template <typename T>
+        class IsLiteral : public std::false_type
+        {
+        };
+
+        template <auto v>
+        class IsLiteral<Literal<v>> : public std::true_type
+        {
+        };
+
+        // Number of leading arms whose patterns satisfy Pred.
+        template <template <typename> class Pred, typename... PatternPairs>
+        constexpr size_t nbLeading()
+        {
+            constexpr bool satisfied[] = {Pred<typename PatternPairs::PatternT>::value...,
+                                          false};
+            size_t n = 0;
+            while (satisfied[n])
+            {
+                ++n;
+            }
+            return n;
+        }
+
+        template <size_t nb, typename... PatternPairs>
+        class LeadingPatterns
+        {
+            template <size_t... I>
+            static auto impl(std::index_sequence<I...>)
+                -> std::tuple<typename std::tuple_element_t<
+                    I, std::tuple<PatternPairs...>>::PatternT...>;
+
+        public:
+            using type = decltype(impl(std::make_index_sequence<nb>{}));
+        };
+
+        template <typename T, bool = std::is_enum_v<T>>
+        class Ordinal
+        {
+        public:
+            using type = T;
+        };
+
+        template <typename T>
+        class Ordinal<T, true>
+        {
+        public:
+            using type = std::underlying_type_t<T>;
+        };
+
+        // Literal keys sorted ascending with the arm index of each key.
+        // Duplicated keys keep the first arm, like the sequential matching.
+        template <typename OrdinalT, size_t nbKeys>
+        class KeyTable
+        {
+        public:
+            std::array<OrdinalT, nbKeys> keys;
+            std::array<size_t, nbKeys> arms;
+            size_t size;
+        };
+
+        template <typename OrdinalT, size_t nbKeys>
+        constexpr auto sortKeys(std::array<OrdinalT, nbKeys> const &keys)
+        {
+            KeyTable<OrdinalT, nbKeys> table{};
+            for (size_t i = 0; i < nbKeys; ++i)
+            {
+                auto duplicated = false;
+                for (size_t k = 0; k < table.size; ++k)
+                {
+                    duplicated = duplicated || table.keys[k] == keys[i];
+                }
+                if (duplicated)
+                {
+                    continue;
+                }
+                auto j = table.size;
+                for (; j > 0 && keys[i] < table.keys[j - 1]; --j)
+                {
+                    table.keys[j] = table.keys[j - 1];
+                    table.arms[j] = table.arms[j - 1];
+                }
+                table.keys[j] = keys[i];
+                table.arms[j] = i;
+                ++table.size;
+            }
+            return table;
+        }
+
+        template <size_t nbKeys>
+        using ArmIndexT = std::conditional_t<
+            (nbKeys < UINT8_MAX), uint8_t,
+            std::conditional_t<(nbKeys < UINT16_MAX), uint16_t, size_t>>;
+
+        template <typename UnsignedT, size_t nbKeys, size_t denseSize, typename Table>
+        constexpr auto makeDenseTable(Table const &table)
+        {
+            using IndexT = ArmIndexT<nbKeys>;
+            std::array<IndexT, denseSize> dense{};
+            for (auto &d : dense)
+            {
+                d = static_cast<IndexT>(nbKeys);
+            }
+            for (size_t i = 0; i < table.size; ++i)
+            {
+                auto const offset = static_cast<UnsignedT>(
+                    static_cast<UnsignedT>(table.keys[i]) -
+                    static_cast<UnsignedT>(table.keys[0]));
+                if (offset < denseSize)
+                {
+                    dense[offset] = static_cast<IndexT>(table.arms[i]);
+                }
+            }
+            return dense;
+        }
+
+        // Maps a value to the index of the first literal arm equal to it, or to
+        // the number of literal arms when none is equal.
+        template <typename Value, typename Literals, typename = std::void_t<>>
+        class LiteralDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value, auto... vs>
+        class LiteralDispatch<
+            Value, std::tuple<Literal<vs>...>,
+            std::enable_if_t<(sizeof...(vs) > 1) &&
+                             (std::is_integral_v<Value> || std::is_enum_v<Value>) &&
+                             !std::is_same_v<Value, bool> &&
+                             (std::is_same_v<std::common_type_t<Value, decltype(vs)>,
+                                             std::common_type_t<Value, decltype(vs)...>> &&
+                              ...)>>
+        {
+            using KeyT = std::common_type_t<Value, decltype(vs)...>;
+            using OrdinalT = typename Ordinal<KeyT>::type;
+            using UnsignedT = std::make_unsigned_t<OrdinalT>;
+            constexpr static auto nbKeys = sizeof...(vs);
+
+            constexpr static auto table = sortKeys(std::array<OrdinalT, nbKeys>{
+                static_cast<OrdinalT>(static_cast<KeyT>(vs))...});
+            constexpr static uintmax_t span =
+                static_cast<UnsignedT>(static_cast<UnsignedT>(table.keys[table.size - 1]) -
+                                       static_cast<UnsignedT>(table.keys[0]));
+            // Switch-like jump table when keys fill at least a quarter of their span,
+            // binary search over the sorted keys otherwise.
+            constexpr static auto isDense = span < 4 * nbKeys;
+            constexpr static auto denseTable =
+                makeDenseTable<UnsignedT, nbKeys,
+                               isDense ? static_cast<size_t>(span) + 1 : 1>(table);
+
+        public:
+            constexpr static auto enabled = true;
+
+            template <typename PairsTuple, typename Prepared>
+            constexpr static size_t lookup(Value const &value, PairsTuple const &,
+                                           Prepared const &)
+            {
+                auto const key = static_cast<OrdinalT>(static_cast<KeyT>(value));
+                if constexpr (isDense)
+                {
+                    auto const offset = static_cast<UnsignedT>(
+                        static_cast<UnsignedT>(key) - static_cast<UnsignedT>(table.keys[0]));
+                    return offset < denseTable.size() ? denseTable[offset] : nbKeys;
+                }
+                else
+                {
+                    size_t low = 0;
+                    for (auto n = table.size; n > 1; n -= n / 2)
+                    {
+                        low = table.keys[low + n / 2] <= key ? low + n / 2 : low;
+                    }
+                    return table.keys[low] == key ? table.arms[low] : nbKeys;
+                }
+            }
+        };
+
+        template <typename T>
+        class IsStringLiteral : public std::false_type
+        {
+        };
+
+        template <size_t N>
+        class IsStringLiteral<StringLiteral<N>> : public std::true_type
+        {
+        };
+
+        template <size_t nbKeys, size_t maxLength>
+        class LengthGroups
+        {
+        public:
+            // Group index of each length, nbGroups for lengths of no arm.
+            std::array<size_t, maxLength + 1> groupOfLength;
+            std::array<size_t, nbKeys + 1> lengthOfGroup;
+            size_t nbGroups;
+        };
+
+        template <size_t... Ns>
+        constexpr auto makeLengthGroups()
+        {
+            constexpr size_t lengths[] = {Ns...};
+            constexpr auto maxLength = std::max({Ns...});
+            LengthGroups<sizeof...(Ns), maxLength> groups{};
+            for (size_t length = 0; length <= maxLength; ++length)
+            {
+                auto used = false;
+                for (auto l : lengths)
+                {
+                    used = used || l == length;
+                }
+                if (used)
+                {
+                    groups.lengthOfGroup[groups.nbGroups] = length;
+                    ++groups.nbGroups;
+                }
+            }
+            for (size_t length = 0; length <= maxLength; ++length)
+            {
+                groups.groupOfLength[length] = groups.nbGroups;
+                for (size_t g = 0; g < groups.nbGroups; ++g)
+                {
+                    if (groups.lengthOfGroup[g] == length)
+                    {
+                        groups.groupOfLength[length] = g;
+                    }
+                }
+            }
+            return groups;
+        }
+
+        // Maps a string to the index of the first string literal arm equal to
+        // it, switching on the length first, then comparing the first character
+        // and the rest of arms of that length.
+        template <typename Value, typename Patterns, typename = std::void_t<>>
+        class StringDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value, size_t... Ns>
+        class StringDispatch<Value, std::tuple<StringLiteral<Ns>...>,
+                             std::enable_if_t<(sizeof...(Ns) > 1) &&
+                                              isStringLikeV<Value const &>>>
+        {
+            constexpr static auto nbKeys = sizeof...(Ns);
+            constexpr static size_t lengths[] = {Ns...};
+            constexpr static auto groups = makeLengthGroups<Ns...>();
+
+            template <size_t group, typename PairsTuple, size_t... I>
+            constexpr static size_t findInGroup(char const *str, PairsTuple const &pairs,
+                                                std::index_sequence<I...>)
+            {
+                auto arm = nbKeys;
+                static_cast<void>(
+                    ((lengths[I] == groups.lengthOfGroup[group] &&
+                      get<I>(pairs).pattern().equalSameSize(str) && (arm = I, true)) ||
+                     ...));
+                return arm;
+            }
+
+            template <size_t group, typename PairsTuple>
+            constexpr static size_t find(char const *str, PairsTuple const &pairs)
+            {
+                if constexpr (group < groups.nbGroups)
+                {
+                    return findInGroup<group>(str, pairs, std::make_index_sequence<nbKeys>{});
+                }
+                else
+                {
+                    static_cast<void>(str);
+                    static_cast<void>(pairs);
+                    return nbKeys;
+                }
+            }
+
+            template <typename PairsTuple, size_t... G>
+            constexpr static size_t findAt(size_t group, char const *str,
+                                           PairsTuple const &pairs, std::index_sequence<G...>)
+            {
+                using Find = size_t (*)(char const *, PairsTuple const &);
+                constexpr Find finds[] = {&find<G, PairsTuple>...};
+                return finds[group](str, pairs);
+            }
+
+            template <typename PairsTuple, size_t... I>
+            constexpr static bool allExact(PairsTuple const &pairs, std::index_sequence<I...>)
+            {
+                return (get<I>(pairs).pattern().exact() && ...);
+            }
+
+            template <typename PairsTuple, size_t... I>
+            constexpr static size_t findSequential(std::string_view str, PairsTuple const &pairs,
+                                                   std::index_sequence<I...>)
+            {
+                auto arm = nbKeys;
+                static_cast<void>(
+                    ((get<I>(pairs).pattern().equal(str) && (arm = I, true)) || ...));
+                return arm;
+            }
+
+        public:
+            constexpr static auto enabled = true;
+
+            template <typename PairsTuple, typename Prepared>
+            constexpr static size_t lookup(Value const &value, PairsTuple const &pairs,
+                                           Prepared const &)
+            {
+                if constexpr (std::is_pointer_v<Value>)
+                {
+                    if (value == nullptr)
+                    {
+                        return nbKeys;
+                    }
+                }
+                std::string_view const str = value;
+                // Lengths of arms not being exact are only known at run time.
+                if (!allExact(pairs, std::make_index_sequence<nbKeys>{}))
+                {
+                    return findSequential(str, pairs, std::make_index_sequence<nbKeys>{});
+                }
+                if (str.size() >= groups.groupOfLength.size())
+                {
+                    return nbKeys;
+                }
+                return findAt(groups.groupOfLength[str.size()], str.data(), pairs,
+                              std::make_index_sequence<nbKeys + 1>{});
+            }
+        };
+
+        template <typename T>
+        class IsInterval : public std::false_type
+        {
+        };
+
+        template <typename T>
+        class IsInterval<Interval<T>> : public std::true_type
+        {
+        };
+
+        // Whether all values in l are less than those in r, with l not empty.
+        template <typename T>
+        constexpr bool precedes(Interval<T> const &l, Interval<T> const &r)
+        {
+            auto const nonEmpty =
+                !l.hasLower() || !l.hasUpper() || l.lower() < l.upper() ||
+                (!(l.upper() < l.lower()) && l.lowerClosed() && l.upperClosed());
+            auto const separated =
+                l.hasUpper() && r.hasLower() &&
+                (l.upper() < r.lower() ||
+                 (!(r.lower() < l.upper()) && !(l.upperClosed() && r.lowerClosed())));
+            return nonEmpty && separated;
+        }
+
+        template <typename T, size_t nb, typename PairsTuple, size_t... I>
+        constexpr auto leadingIntervals(PairsTuple const &pairs, std::index_sequence<I...>)
+        {
+            return std::array<Interval<T> const *, nb>{
+                std::addressof(get<I>(pairs).pattern())...};
+        }
+
+        template <typename T, size_t nb, typename PairsTuple>
+        constexpr auto leadingIntervals(PairsTuple const &pairs)
+        {
+            return leadingIntervals<T, nb>(pairs, std::make_index_sequence<nb>{});
+        }
+
+        // Whether leading interval arms are ascending and disjoint. This only
+        // depends on the arms, so it can be kept along with them.
+        template <typename Patterns>
+        class IntervalOrder
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename T, typename... Ts>
+        class IntervalOrder<std::tuple<Interval<T>, Interval<Ts>...>>
+        {
+            constexpr static auto nbKeys = sizeof...(Ts) + 1;
+
+        public:
+            constexpr static auto enabled = (sizeof...(Ts) > 0) && (std::is_same_v<T, Ts> && ...);
+
+            template <typename PairsTuple>
+            constexpr static bool ordered(PairsTuple const &pairs)
+            {
+                auto const arms = leadingIntervals<T, nbKeys>(pairs);
+                auto ordered = true;
+                for (size_t i = 1; i < nbKeys; ++i)
+                {
+                    ordered = ordered & precedes(*arms[i - 1], *arms[i]);
+                }
+                return ordered;
+            }
+        };
+
+        // Arms of inline matches. They are not prepared, as that would cost as
+        // much as the lookups it saves.
+        class Unprepared
+        {
+        };
+
+        // What key lookups need to know about the arms beyond their types, for
+        // arms kept and matched many times.
+        template <typename... PatternPairs, typename PairsTuple>
+        constexpr auto prepareArms(PairsTuple const &pairs)
+        {
+            using IntervalOrderT = IntervalOrder<typename LeadingPatterns<
+                nbLeading<IsInterval, PatternPairs...>(), PatternPairs...>::type>;
+            if constexpr (IntervalOrderT::enabled)
+            {
+                return IntervalOrderT::ordered(pairs);
+            }
+            else
+            {
+                static_cast<void>(pairs);
+                return std::tuple<>{};
+            }
+        }
+
+        // Maps a value to the index of the first interval arm containing it.
+        // Disjoint arms in ascending order are binary searched, others are
+        // checked in order.
+        template <typename Value, typename Patterns, typename = std::void_t<>>
+        class IntervalDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value, typename T, typename... Ts>
+        class IntervalDispatch<Value, std::tuple<Interval<T>, Interval<Ts>...>,
+                               std::enable_if_t<(sizeof...(Ts) > 0) &&
+                                                std::is_arithmetic_v<Value> &&
+                                                (std::is_same_v<T, Ts> && ...)>>
+        {
+            constexpr static auto nbKeys = sizeof...(Ts) + 1;
+            // Whether comparing values with the bounds keeps the order of the
+            // bounds, which the arms were told ascending in.
+            constexpr static auto searchable =
+                std::is_same_v<Value, T> ||
+                (std::is_integral_v<Value> && std::is_integral_v<T> &&
+                 std::is_signed_v<Value> == std::is_signed_v<T> &&
+                 sizeof(Value) <= sizeof(T)) ||
+                (std::is_floating_point_v<Value> && std::is_floating_point_v<T>);
+
+            template <typename PairsTuple, size_t... I>
+            constexpr static size_t findSequential(Value const &value, PairsTuple const &pairs,
+                                                   std::index_sequence<I...>)
+            {
+                auto arm = nbKeys;
+                static_cast<void>(((get<I>(pairs).pattern()(value) && (arm = I, true)) || ...));
+                return arm;
+            }
+
+        public:
+            constexpr static auto enabled = true;
+
+            template <typename PairsTuple>
+            constexpr static size_t lookup(Value const &value, PairsTuple const &pairs,
+                                           Unprepared)
+            {
+                return findSequential(value, pairs, std::make_index_sequence<nbKeys>{});
+            }
+
+            // ordered tells whether the arms are ascending and disjoint.
+            template <typename PairsTuple>
+            constexpr static size_t lookup(Value const &value, PairsTuple const &pairs,
+                                           bool ordered)
+            {
+                if constexpr (searchable)
+                {
+                    if (ordered)
+                    {
+                        auto const arms = leadingIntervals<T, nbKeys>(pairs);
+                        size_t low = 0;
+                        for (auto n = nbKeys; n > 1; n -= n / 2)
+                        {
+                            low = arms[low + n / 2]->aboveLower(value) ? low + n / 2 : low;
+                        }
+                        return (*arms[low])(value) ? low : nbKeys;
+                    }
+                }
+                else
+                {
+                    static_cast<void>(ordered);
+                }
+                return findSequential(value, pairs, std::make_index_sequence<nbKeys>{});
+            }
+        };
+
+        template <typename T>
+        class AsPointer;
+
+        template <typename Unary>
+        class AsAlternativeOf
+        {
+        public:
+            using type = void;
+        };
+
+        template <typename T>
+        class AsAlternativeOf<AsPointer<T>>
+        {
+        public:
+            using type = T;
+        };
+
+        // The T of as<T>(...) patterns, void for other patterns.
+        template <typename Pattern>
+        class AsAlternative
+        {
+        public:
+            using type = void;
+        };
+
+        template <typename Unary, typename Pattern>
+        class AsAlternative<App<Unary, Pattern>>
+        {
+        public:
+            using type = typename AsAlternativeOf<std::decay_t<Unary>>::type;
+        };
+
+        template <typename Pattern, typename Pred>
+        class AsAlternative<PostCheck<Pattern, Pred>> : public AsAlternative<Pattern>
+        {
+        };
+
+        template <typename Pattern>
+        using AsAlternativeT = typename AsAlternative<Pattern>::type;
+
+        template <typename Pattern>
+        class IsAs : public std::bool_constant<!std::is_void_v<AsAlternativeT<Pattern>>>
+        {
+        };
+
+        // Index of T among the alternatives of Variant, or the number of
+        // alternatives when T is not exactly one of them.
+        template <typename T, typename Variant, size_t... I>
+        constexpr size_t alternativeIndex(std::index_sequence<I...>)
+        {
+            constexpr bool same[] = {std::is_same_v<T, std::variant_alternative_t<I, Variant>>...};
+            auto index = sizeof...(I);
+            size_t nbSame = 0;
+            for (size_t i = 0; i < sizeof...(I); ++i)
+            {
+                if (same[i])
+                {
+                    index = i;
+                    ++nbSame;
+                }
+            }
+            return nbSame == 1 ? index : sizeof...(I);
+        }
+
+        // Groups leading as<T>(...) arms by the variant alternative they accept,
+        // so that only the arms of the active alternative are tried.
+        template <typename Value, typename Patterns, typename = std::void_t<>>
+        class VariantDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value, typename... Patterns>
+        class VariantDispatch<Value, std::tuple<Patterns...>,
+                              std::void_t<decltype(std::variant_size<Value>::value),
+                                          decltype(std::declval<Value const &>().index())>>
+        {
+            constexpr static auto nbAlternatives = std::variant_size<Value>::value;
+            constexpr static size_t groups[] = {
+                alternativeIndex<AsAlternativeT<Patterns>, Value>(
+                    std::make_index_sequence<nbAlternatives>{})...,
+                nbAlternatives};
+
+        public:
+            constexpr static auto enabled =
+                sizeof...(Patterns) > 1 && ((alternativeIndex<AsAlternativeT<Patterns>, Value>(
+                                                 std::make_index_sequence<nbAlternatives>{}) <
+                                             nbAlternatives) &&
+                                            ...);
+            // The last group, for valueless variants, has no arms.
+            constexpr static auto nbGroups = nbAlternatives + 1;
+
+            constexpr static size_t groupOf(size_t arm) { return groups[arm]; }
+
+            constexpr static size_t lookup(Value const &value)
+            {
+                auto const index = value.index();
+                return index < nbAlternatives ? index : nbAlternatives;
+            }
+        };
+
+        // Whether as<T> down casts values of type B via dynamic_cast, i.e. the
+        // outcome only depends on their dynamic type. Defined in utility.h.
+        template <typename T, typename B>
+        class ViaDowncast;
+
+        // Arms resolved per type, keyed by the address of its std::type_info,
+        // in a table shared by threads and filled on first use. Owner tells
+        // the tables of different arms apart.
+        template <typename Owner>
+        class TypeArmTable
+        {
+            constexpr static uint32_t kPENDING = UINT32_MAX;
+            constexpr static size_t kNB_ENTRIES = 256;
+            constexpr static size_t kNB_PROBES = 8;
+
+            class Entry
+            {
+            public:
+                std::atomic<std::type_info const *> type{};
+                std::atomic<uint32_t> arm{kPENDING};
+            };
+
+            inline static std::array<Entry, kNB_ENTRIES> sEntries{};
+
+        public:
+            // The arm of type, via resolve() when not known yet.
+            template <typename Resolve>
+            static size_t find(std::type_info const *type, Resolve const &resolve)
+            {
+                auto const hash = reinterpret_cast<uintptr_t>(type) >> 4;
+                for (size_t i = 0; i < kNB_PROBES; ++i)
+                {
+                    auto &entry = sEntries[(hash + i) % kNB_ENTRIES];
+                    auto const *key = entry.type.load(std::memory_order_acquire);
+                    if (key == nullptr &&
+                        entry.type.compare_exchange_strong(key, type, std::memory_order_acq_rel))
+                    {
+                        auto const arm = static_cast<uint32_t>(resolve());
+                        entry.arm.store(arm, std::memory_order_release);
+                        return arm;
+                    }
+                    if (key == type)
+                    {
+                        auto const arm = entry.arm.load(std::memory_order_acquire);
+                        return arm != kPENDING ? arm : resolve();
+                    }
+                }
+                return resolve();
+            }
+        };
+
+        // Resolves leading as<T>(...) arms over polymorphic values to the first
+        // arm whose cast succeeds, per dynamic type. Arms before it are
+        // skipped, while arms after it are tried in order, which covers
+        // intermediate base classes. Values that are not at the start of
+        // their most derived object try all arms.
+        template <typename Value, typename Patterns, typename = std::void_t<>>
+        class HierarchyDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value, typename... Patterns>
+        class HierarchyDispatch<Value, std::tuple<Patterns...>,
+                                std::enable_if_t<std::is_polymorphic_v<Value>>>
+        {
+            constexpr static auto nbArms = sizeof...(Patterns);
+
+            template <typename T>
+            static bool castsTo(Value const &value)
+            {
+                return dynamic_cast<T const *>(std::addressof(value)) != nullptr;
+            }
+
+            static size_t firstArm(Value const &value)
+            {
+                using CastsTo = bool (*)(Value const &);
+                constexpr CastsTo casts[] = {&castsTo<AsAlternativeT<Patterns>>...};
+                size_t arm = 0;
+                while (arm < nbArms && !casts[arm](value))
+                {
+                    ++arm;
+                }
+                return arm;
+            }
+
+        public:
+            constexpr static auto enabled =
+                sizeof...(Patterns) > 1 && (ViaDowncast<AsAlternativeT<Patterns>, Value>::value && ...);
+
+            // The first arm that can match.
+            static size_t lookup(Value const &value)
+            {
+                if (static_cast<void const *>(std::addressof(value)) !=
+                    dynamic_cast<void const *>(std::addressof(value)))
+                {
+                    return 0;
+                }
+                return TypeArmTable<HierarchyDispatch>::find(&typeid(value),
+                                                             [&] { return firstArm(value); });
+            }
+        };
+
+        // Groups leading as<T>(...) arms over std::any by T, so that type() is
+        // read once and only the arms for it are tried. Types are resolved
+        // via std::type_info comparisons once per type_info object, unless
+        // MATCHIT_ANY_TYPE_POINTERS tells their addresses suffice.
+        template <typename Value, typename Patterns, typename = std::void_t<>>
+        class AnyDispatch
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename... Patterns>
+        class AnyDispatch<std::any, std::tuple<Patterns...>>
+        {
+            constexpr static auto nbArms = sizeof...(Patterns);
+
+            // The first arm for the same type as T.
+            template <typename T>
+            constexpr static size_t firstOf()
+            {
+                constexpr bool same[] = {std::is_same_v<T, AsAlternativeT<Patterns>>...};
+                size_t arm = 0;
+                while (!same[arm])
+                {
+                    ++arm;
+                }
+                return arm;
+            }
+
+            constexpr static size_t groups[] = {firstOf<AsAlternativeT<Patterns>>()..., nbArms};
+
+            static size_t groupOfType(std::type_info const &type)
+            {
+                size_t arm = 0;
+#if MATCHIT_ANY_TYPE_POINTERS
+                constexpr static std::type_info const *types[] = {
+                    &typeid(AsAlternativeT<Patterns>)...};
+                while (arm < nbArms && types[arm] != &type)
+#else
+                using IsType = bool (*)(std::type_info const &);
+                constexpr static IsType isType[] = {
+                    [](std::type_info const &t) { return t == typeid(AsAlternativeT<Patterns>); }...};
+                while (arm < nbArms && !isType[arm](type))
+#endif
+                {
+                    ++arm;
+                }
+                return groups[arm];
+            }
+
+        public:
+            constexpr static auto enabled = sizeof...(Patterns) > 1;
+            // The last group, for types of no arm, has no arms.
+            constexpr static auto nbGroups = nbArms + 1;
+
+            constexpr static size_t groupOf(size_t arm) { return groups[arm]; }
+
+            static size_t lookup(std::any const &value)
+            {
+                auto const &type = value.type();
+#if MATCHIT_ANY_TYPE_POINTERS
+                return groupOfType(type);
+#else
+                return TypeArmTable<AnyDispatch>::find(&type, [&] { return groupOfType(type); });
+#endif
+            }
+        };
+
+        // Patterns whose arms can be told disjoint from one another.
+        template <typename Pattern>
+        class IsDisjointKey
+            : public std::bool_constant<std::is_arithmetic_v<Pattern> || std::is_enum_v<Pattern>>
+        {
+        };
+
+        template <auto v>
+        class IsDisjointKey<Literal<v>> : public std::true_type
+        {
+        };
+
+        template <typename T>
+        class IsDisjointKey<Interval<T>> : public std::true_type
+        {
+        };
+
+        template <size_t N>
+        class IsDisjointKey<StringLiteral<N>> : public std::true_type
+        {
+        };
+
+        // Values known to be matched by a pattern: one value or a range of
+        // values of one kind of integers, or one string. Integers compare the
+        // same when they have the same size, signedness and value, so that is
+        // all that is kept of their types. They are kept as ordinals, i.e.
+        // with the order of their values.
+        class ArmKey
+        {
+        public:
+            constexpr static size_t kSTRING = 1;
+
+            size_t mKind;
+            uintmax_t mLower;
+            uintmax_t mUpper;
+            bool mHasLower;
+            bool mLowerClosed;
+            bool mHasUpper;
+            bool mUpperClosed;
+            std::string_view mString;
+
+            constexpr bool isValue() const
+            {
+                return mKind == kSTRING || (mHasLower && mHasUpper && mLowerClosed &&
+                                            mUpperClosed && mLower == mUpper);
+            }
+            // Whether all values of key are matched, known for single values.
+            constexpr bool covers(ArmKey const &key) const
+            {
+                return isValue() && key.isValue() && mKind == key.mKind &&
+                       mLower == key.mLower && mString == key.mString;
+            }
+            // Whether values of this key are all below those of key.
+            constexpr bool precedes(ArmKey const &key) const
+            {
+                return mHasUpper && key.mHasLower &&
+                       (mUpper < key.mLower ||
+                        (mUpper == key.mLower && !(mUpperClosed && key.mLowerClosed)));
+            }
+            // Whether no value is of both keys, false when not known.
+            constexpr bool disjoint(ArmKey const &key) const
+            {
+                if (mKind != key.mKind)
+                {
+                    return false;
+                }
+                if (mKind == kSTRING)
+                {
+                    return mString != key.mString;
+                }
+                return precedes(key) || key.precedes(*this);
+            }
+        };
+
+        template <typename T>
+        constexpr auto armKind()
+        {
+            using IntT = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>,
+                                                     std::common_type<T>>::type;
+            return sizeof(T) * 2 + (std::is_signed_v<IntT> ? 1 : 0);
+        }
+
+        template <typename T>
+        constexpr auto armOrdinal(T const &v)
+        {
+            using IntT = typename std::conditional_t<std::is_enum_v<T>, std::underlying_type<T>,
+                                                     std::common_type<T>>::type;
+            if constexpr (std::is_signed_v<IntT>)
+            {
+                // Negative values come first.
+                return static_cast<uintmax_t>(static_cast<intmax_t>(v)) ^
+                       (uintmax_t{1} << (std::numeric_limits<uintmax_t>::digits - 1));
+            }
+            else
+            {
+                return static_cast<uintmax_t>(v);
+            }
+        }
+
+        template <typename T>
+        constexpr auto makeArmKey(T const &v)
+        {
+            auto const ordinal = armOrdinal(v);
+            return ArmKey{armKind<T>(), ordinal, ordinal, true, true, true, true, {}};
+        }
+
+        template <typename T>
+        constexpr auto makeArmKey(Interval<T> const &interval)
+        {
+            return ArmKey{armKind<T>(),
+                          armOrdinal(interval.lower()),
+                          armOrdinal(interval.upper()),
+                          interval.hasLower(),
+                          interval.lowerClosed(),
+                          interval.hasUpper(),
+                          interval.upperClosed(),
+                          {}};
+        }
+
+        template <size_t N>
+        constexpr auto makeArmKey(StringLiteral<N> const &str)
+        {
+            return ArmKey{ArmKey::kSTRING, 0, 0, true, true, true, true,
+                          std::string_view{str.data(), str.size()}};
+        }
+
+        // What a pattern tells about the values it matches: all of them when
+        // irrefutable, else at least its keys, and only them unless opaque.
+        // Keys come from the type of the pattern, and also from its value
+        // when byValue. Types tell enough to drop arms at compile time, values
+        // are known to matchers.
+        template <typename Pattern, bool byValue>
+        class KnownKeys
+        {
+            constexpr static bool isKey =
+                byValue && (std::is_integral_v<Pattern> || std::is_enum_v<Pattern>);
+
+        public:
+            constexpr static bool irrefutable = false;
+            constexpr static bool opaque = !isKey;
+            constexpr static size_t nbKeys = isKey ? 1 : 0;
+            template <size_t N>
+            constexpr static void write(Pattern const *pattern, std::array<ArmKey, N> &keys,
+                                        size_t &n)
+            {
+                if constexpr (isKey)
+                {
+                    keys[n++] = makeArmKey(*pattern);
+                }
+                else
+                {
+                    static_cast<void>(pattern);
+                    static_cast<void>(keys);
+                    static_cast<void>(n);
+                }
+            }
+        };
+
+        template <bool byValue>
+        class KnownKeys<Wildcard, byValue> : public KnownKeys<void, false>
+        {
+        public:
+            constexpr static bool irrefutable = true;
+            constexpr static bool opaque = false;
+        };
+
+        template <auto v, bool byValue>
+        class KnownKeys<Literal<v>, byValue> : public KnownKeys<void, false>
+        {
+            using T = decltype(v);
+            constexpr static bool isKey = std::is_integral_v<T> || std::is_enum_v<T>;
+
+        public:
+            constexpr static bool opaque = !isKey;
+            constexpr static size_t nbKeys = isKey ? 1 : 0;
+            template <size_t N>
+            constexpr static void write(Literal<v> const *, std::array<ArmKey, N> &keys,
+                                        size_t &n)
+            {
+                if constexpr (isKey)
+                {
+                    keys[n++] = makeArmKey(v);
+                }
+                else
+                {
+                    static_cast<void>(keys);
+                    static_cast<void>(n);
+                }
+            }
+        };
+
+        // Floating point intervals are left opaque.
+        template <typename T>
+        class KnownKeys<Interval<T>, true>
+        {
+            constexpr static bool isKey = std::is_integral_v<T>;
+
+        public:
+            constexpr static bool irrefutable = false;
+            constexpr static bool opaque = !isKey;
+            constexpr static size_t nbKeys = isKey ? 1 : 0;
+            template <size_t N>
+            constexpr static void write(Interval<T> const *interval, std::array<ArmKey, N> &keys,
+                                        size_t &n)
+            {
+                if constexpr (isKey)
+                {
+                    keys[n++] = makeArmKey(*interval);
+                }
+                else
+                {
+                    static_cast<void>(interval);
+                    static_cast<void>(keys);
+                    static_cast<void>(n);
+                }
+            }
+        };
+
+        template <size_t M>
+        class KnownKeys<StringLiteral<M>, true>
+        {
+        public:
+            constexpr static bool irrefutable = false;
+            constexpr static bool opaque = false;
+            constexpr static size_t nbKeys = 1;
+            template <size_t N>
+            constexpr static void write(StringLiteral<M> const *str, std::array<ArmKey, N> &keys,
+                                        size_t &n)
+            {
+                keys[n++] = makeArmKey(*str);
+            }
+        };
+
+        template <typename... Patterns, bool byValue>
+        class KnownKeys<Or<Patterns...>, byValue>
+        {
+            template <size_t N, size_t... I>
+            constexpr static void writeEach(Or<Patterns...> const *orPat,
+                                            std::array<ArmKey, N> &keys, size_t &n,
+                                            std::index_sequence<I...>)
+            {
+                static_cast<void>(orPat);
+                static_cast<void>(keys);
+                static_cast<void>(n);
+                (KnownKeys<Patterns, byValue>::write(
+                     byValue ? std::addressof(std::get<I>(orPat->patterns())) : nullptr, keys,
+                     n),
+                 ...);
+            }
+
+        public:
+            constexpr static bool irrefutable = (KnownKeys<Patterns, byValue>::irrefutable || ...);
+            constexpr static bool opaque = (KnownKeys<Patterns, byValue>::opaque || ...);
+            constexpr static size_t nbKeys = (KnownKeys<Patterns, byValue>::nbKeys + ... + 0);
+            template <size_t N>
+            constexpr static void write(Or<Patterns...> const *orPat, std::array<ArmKey, N> &keys,
+                                        size_t &n)
+            {
+                writeEach(orPat, keys, n, std::index_sequence_for<Patterns...>{});
+            }
+        };
+
+        template <typename... Patterns, bool byValue>
+        class KnownKeys<And<Patterns...>, byValue> : public KnownKeys<void, false>
+        {
+        public:
+            constexpr static bool irrefutable = (KnownKeys<Patterns, byValue>::irrefutable && ...);
+            constexpr static bool opaque = !irrefutable;
+        };
+
+        // What is known of the arms of a match: arms subsumed by earlier ones,
+        // that are never taken, and pairs of arms matching no value in common.
+        template <size_t nbArms, size_t nbKeys>
+        class ArmFacts
+        {
+            std::array<bool, nbArms + 1> mIrrefutable{};
+            std::array<bool, nbArms + 1> mOpaque{};
+            // Keys of all arms one after the other, those of arm i ending at
+            // mEnds[i].
+            std::array<size_t, nbArms + 1> mEnds{};
+            std::array<ArmKey, nbKeys + 1> mKeys{};
+            std::array<bool, nbArms + 1> mReachable{};
+
+            constexpr size_t begin(size_t arm) const { return arm == 0 ? 0 : mEnds[arm - 1]; }
+            // Arms matching exactly their keys.
+            constexpr bool exact(size_t arm) const
+            {
+                return !mOpaque[arm] && !mIrrefutable[arm] && begin(arm) != mEnds[arm];
+            }
+            constexpr bool covered(size_t first, size_t last, ArmKey const &key) const
+            {
+                for (auto i = first; i < last; ++i)
+                {
+                    if (mKeys[i].covers(key))
+                    {
+                        return true;
+                    }
+                }
+                return false;
+            }
+            constexpr void resolveReachable()
+            {
+                auto afterIrrefutable = false;
+                for (size_t i = 0; i < nbArms; ++i)
+                {
+                    auto subsumed = exact(i);
+                    for (auto k = begin(i); subsumed && k < mEnds[i]; ++k)
+                    {
+                        subsumed = covered(0, begin(i), mKeys[k]);
+                    }
+                    mReachable[i] = !afterIrrefutable && !subsumed;
+                    afterIrrefutable = afterIrrefutable || mIrrefutable[i];
+                }
+            }
+
+        public:
+            template <bool byValue, typename... Patterns>
+            constexpr static auto of(Patterns const *...patterns)
+            {
+                ArmFacts facts{};
+                size_t arm = 0;
+                size_t n = 0;
+                static_cast<void>(
+                    ((facts.mIrrefutable[arm] = KnownKeys<Patterns, byValue>::irrefutable,
+                      facts.mOpaque[arm] = KnownKeys<Patterns, byValue>::opaque,
+                      KnownKeys<Patterns, byValue>::write(patterns, facts.mKeys, n),
+                      facts.mEnds[arm++] = n),
+                     ...));
+                facts.resolveReachable();
+                return facts;
+            }
+
+            constexpr bool reachable(size_t arm) const { return mReachable[arm]; }
+            constexpr bool allReachable() const
+            {
+                for (size_t i = 0; i < nbArms; ++i)
+                {
+                    if (!mReachable[i])
+                    {
+                        return false;
+                    }
+                }
+                return true;
+            }
+            // Whether some arm matches all values equal to key.
+            constexpr bool matchesKey(ArmKey const &key) const
+            {
+                return covered(0, begin(nbArms), key);
+            }
+            // Whether no value matches both arms, false when not known.
+            constexpr bool disjoint(size_t i, size_t j) const
+            {
+                if (!exact(i) || !exact(j))
+                {
+                    return false;
+                }
+                for (auto k = begin(i); k < mEnds[i]; ++k)
+                {
+                    for (auto l = begin(j); l < mEnds[j]; ++l)
+                    {
+                        if (!mKeys[k].disjoint(mKeys[l]))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+            // Whether no value matches two of the first nb arms.
+            constexpr bool disjoint(size_t nb) const
+            {
+                for (size_t i = 0; i < nb; ++i)
+                {
+                    for (auto j = i + 1; j < nb; ++j)
+                    {
+                        if (!disjoint(i, j))
+                        {
+                            return false;
+                        }
+                    }
+                }
+                return true;
+            }
+        };
+
+        template <bool byValue, typename... Patterns>
+        using ArmFactsT =
+            ArmFacts<sizeof...(Patterns), (KnownKeys<Patterns, byValue>::nbKeys + ... + 0)>;
+
+        // What the values of the patterns tell about them.
+        template <typename... Patterns>
+        constexpr auto analyzePatterns(Patterns const &...patterns)
+        {
+            return ArmFactsT<true, Patterns...>::template of<true>(std::addressof(patterns)...);
+        }
+
+        // What the values of the arms tell about them.
+        template <typename PairsTuple, size_t... I>
+        constexpr auto analyzeArms(PairsTuple const &pairs, std::index_sequence<I...>)
+        {
+            static_cast<void>(pairs);
+            return analyzePatterns(get<I>(pairs).pattern()...);
+        }
+
+        // Whether no value can match both patterns, false when not known.
+        template <typename L, typename R>
+        constexpr bool disjoint(L const &l, R const &r)
+        {
+            return analyzePatterns(l, r).disjoint(0, 1);
+        }
+
+        // What the types of the arms of a match tell about them, so that
+        // unreachable arms are neither tried nor compiled.
+        template <typename... PatternPairs>
+        class ArmAnalysis
+        {
+            using FactsT = ArmFactsT<false, typename PatternPairs::PatternT...>;
+            constexpr static auto kFACTS =
+                FactsT::template of<false>(static_cast<typename PatternPairs::PatternT const *>(
+                    nullptr)...);
+
+        public:
+            constexpr static bool reachable(size_t arm) { return kFACTS.reachable(arm); }
+            constexpr static bool allReachable() { return kFACTS.allReachable(); }
+            constexpr static bool matchesKey(ArmKey const &key) { return kFACTS.matchesKey(key); }
+        };
+
+        // Arms taken whatever the value, i.e. irrefutable patterns and plain Ids.
+        // Ids nested in other patterns may have to equal each other.
+        template <typename Pattern>
+        constexpr bool takenAlways()
+        {
+            return KnownKeys<Pattern, false>::irrefutable || IsId<Pattern>::value;
+        }
+
+        template <typename T>
+        class IsVariant : public std::false_type
+        {
+        };
+
+        template <typename... Ts>
+        class IsVariant<std::variant<Ts...>> : public std::true_type
+        {
+        };
+
+        // The P of some(P), void for other patterns.
+        template <typename Pattern>
+        class SomeOf
+        {
+        public:
+            using type = void;
+        };
+
+        // The alternative T matched as a whole by as<T>(P) with P irrefutable,
+        // void for other patterns.
+        template <typename Pattern>
+        class CoveredAlternative
+        {
+        public:
+            using type = void;
+        };
+
+        template <typename T, typename Inner>
+        class CoveredAlternative<App<AsPointer<T>, Inner>>
+        {
+            using SomeT = typename SomeOf<Inner>::type;
+
+        public:
+            using type = std::conditional_t<takenAlways<SomeT>(), T, void>;
+        };
+
+        template <typename T, typename Inner>
+        class CoveredAlternative<App<AsPointer<T> const &, Inner>>
+            : public CoveredAlternative<App<AsPointer<T>, Inner>>
+        {
+        };
+
+        // Enums list their enumerators via a constexpr function found by ADL,
+        // e.g. constexpr auto enumerators(Color) { return std::array{...}; }
+        template <typename Enum, typename = std::void_t<>>
+        class HasEnumerators : public std::false_type
+        {
+        };
+
+        template <typename Enum>
+        class HasEnumerators<Enum, std::void_t<decltype(enumerators(std::declval<Enum>()))>>
+            : public std::true_type
+        {
+        };
+
+        template <typename Analysis, typename Enum>
+        constexpr bool coversEnumerators()
+        {
+            for (auto const e : enumerators(Enum{}))
+            {
+                if (!Analysis::matchesKey(makeArmKey(e)))
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        template <typename Variant, typename... PatternPairs, size_t... I>
+        constexpr bool coversAlternatives(std::index_sequence<I...>)
+        {
+            constexpr size_t covered[] = {
+                alternativeIndex<typename CoveredAlternative<typename PatternPairs::PatternT>::type,
+                                 Variant>(std::index_sequence<I...>{})...,
+                sizeof...(I)};
+            for (size_t i = 0; i < sizeof...(I); ++i)
+            {
+                auto found = false;
+                for (auto const c : covered)
+                {
+                    found = found || c == i;
+                }
+                if (!found)
+                {
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        // Which values the arms of a match are known to cover: all of them when
+        // some arm is irrefutable, all the alternatives of a variant when they
+        // are matched by as<T>(_) like arms, or all the enumerators of an enum
+        // when they are matched by literals. Valueless variants and enum
+        // values of no enumerator are left out by the latter two, so enum
+        // matches keep their no-match path.
+        enum class Coverage
+        {
+            kPARTIAL,
+            kENUMERATORS,
+            kALTERNATIVES,
+            kTOTAL
+        };
+
+        template <typename Value, typename... PatternPairs>
+        constexpr Coverage coverage()
+        {
+            using V = std::decay_t<Value>;
+            if constexpr ((takenAlways<typename PatternPairs::PatternT>() || ...))
+            {
+                return Coverage::kTOTAL;
+            }
+            else if constexpr (std::is_enum_v<V> && HasEnumerators<V>::value)
+            {
+                return coversEnumerators<ArmAnalysis<PatternPairs...>, V>()
+                           ? Coverage::kENUMERATORS
+                           : Coverage::kPARTIAL;
+            }
+            else if constexpr (IsVariant<V>::value)
+            {
+                return coversAlternatives<V, PatternPairs...>(
+                           std::make_index_sequence<std::variant_size_v<V>>{})
+                           ? Coverage::kALTERNATIVES
+                           : Coverage::kPARTIAL;
+            }
+            else
+            {
+                return Coverage::kPARTIAL;
+            }
+        }
+
+        // Whether the arms cover all the values expected of the type, e.g.
+        // static_assert(exhaustive<Color>(arms...)) to be told of enumerators
+        // added later.
+        template <typename Value, typename... PatternPairs>
+        constexpr bool exhaustive(PatternPairs const &...)
+        {
+            return coverage<Value, PatternPairs...>() != Coverage::kPARTIAL;
+        }
+
+        // Patterns matching values of type Value without throwing.
+        template <typename Pattern, typename Value>
+        class NothrowPattern : public std::false_type
+        {
+        };
+
+        template <typename Value>
+        class NothrowPattern<Wildcard, Value> : public std::true_type
+        {
+        };
+
+        template <auto v, typename Value>
+        class NothrowPattern<Literal<v>, Value>
+            : public std::bool_constant<noexcept(v == std::declval<Value>())>
+        {
+        };
+
+        template <typename... Patterns, typename Value>
+        class NothrowPattern<Or<Patterns...>, Value>
+            : public std::bool_constant<(NothrowPattern<Patterns, Value>::value && ...)>
+        {
+        };
+
+        template <typename... Patterns, typename Value>
+        class NothrowPattern<And<Patterns...>, Value>
+            : public std::bool_constant<(NothrowPattern<Patterns, Value>::value && ...)>
+        {
+        };
+
+        template <typename T, typename Inner, typename Value>
+        class NothrowPattern<App<AsPointer<T>, Inner>, Value>
+            : public std::bool_constant<
+                  IsVariant<std::decay_t<Value>>::value &&
+                  NothrowPattern<typename SomeOf<Inner>::type, T &>::value>
+        {
+        };
+
+        template <typename T, typename Inner, typename Value>
+        class NothrowPattern<App<AsPointer<T> const &, Inner>, Value>
+            : public NothrowPattern<App<AsPointer<T>, Inner>, Value>
+        {
+        };
+
+        template <typename RetType, typename PatternPair, typename Value>
+        constexpr bool nothrowArm()
+        {
+            using HandlerT = typename PatternPair::HandlerT;
+            using ResultT = typename PatternPair::RetType;
+            return NothrowPattern<typename PatternPair::PatternT, Value>::value &&
+                   std::is_nothrow_invocable_v<HandlerT const &> &&
+                   (std::is_void_v<RetType> || std::is_same_v<ResultT, RetType> ||
+                    std::is_nothrow_constructible_v<RetType, ResultT>);
+        }
+
+        // Whether matching can not throw: no match can be missed, and patterns
+        // and handlers do not throw.
+        template <bool tryOnly, typename Policy, typename Value, typename... PatternPairs>
+        class NothrowMatch
+        {
+            using RetType = typename PatternPairsRetType<PatternPairs...>::RetType;
+
+            constexpr static bool check()
+            {
+                if constexpr (std::is_same_v<Policy, NoInstrumentation> &&
+                              (tryOnly ||
+                               coverage<Value, PatternPairs...>() == Coverage::kTOTAL))
+                {
+                    return (nothrowArm<RetType, PatternPairs, Value>() && ...);
+                }
+                else
+                {
+                    return false;
+                }
+            }
+
+        public:
+            constexpr static bool value = check();
+        };
+
+        template <bool enabled, typename Func, typename PatternPair>
+        constexpr bool tryArmIf(Func const &func, PatternPair const &pair, size_t idx)
+        {
+            if constexpr (enabled)
+            {
+                return func(pair, idx);
+            }
+            else
+            {
+                static_cast<void>(func);
+                static_cast<void>(pair);
+                static_cast<void>(idx);
+                return false;
+            }
+        }
+
+        template <typename Dispatch, typename Analysis, size_t group, typename Func,
+                  typename PairsTuple, size_t... I>
+        constexpr bool tryGroupImpl(Func const &func, PairsTuple const &pairs,
+                                    std::index_sequence<I...>)
+        {
+            return (tryArmIf<Dispatch::groupOf(I) == group && Analysis::reachable(I)>(
+                        func, get<I>(pairs), I) ||
+                    ...);
+        }
+
+        template <typename Dispatch, typename Analysis, size_t group, size_t nbArms,
+                  typename Func, typename PairsTuple>
+        constexpr bool tryGroup(Func const &func, PairsTuple const &pairs)
+        {
+            return tryGroupImpl<Dispatch, Analysis, group>(func, pairs,
+                                                           std::make_index_sequence<nbArms>{});
+        }
+
+        // Tries the arms from start on in order.
+        template <typename Analysis, typename Func, typename PairsTuple, size_t... I>
+        constexpr bool tryArmsFrom(size_t start, Func const &func, PairsTuple const &pairs,
+                                   std::index_sequence<I...>)
+        {
+            return ((I >= start &&
+                     tryArmIf<Analysis::reachable(I)>(func, get<I>(pairs), I)) ||
+                    ...);
+        }
+
+        // Tries the arms of one group in order, comparing groups inline.
+        template <typename Dispatch, typename Analysis, typename Func, typename PairsTuple,
+                  size_t... I>
+        constexpr bool tryGroupIn(size_t group, Func const &func, PairsTuple const &pairs,
+                                  std::index_sequence<I...>)
+        {
+            return ((Dispatch::groupOf(I) == group &&
+                     tryArmIf<Analysis::reachable(I)>(func, get<I>(pairs), I)) ||
+                    ...);
+        }
+
+        // Jump table over the groups of Dispatch, kept static rather than
+        // built on the stack of each match.
+        template <typename Dispatch, typename Analysis, size_t nbArms, typename Func,
+                  typename PairsTuple, typename Groups>
+        class GroupTable;
+
+        template <typename Dispatch, typename Analysis, size_t nbArms, typename Func,
+                  typename PairsTuple, size_t... G>
+        class GroupTable<Dispatch, Analysis, nbArms, Func, PairsTuple, std::index_sequence<G...>>
+        {
+            using Group = bool (*)(Func const &, PairsTuple const &);
+
+        public:
+            constexpr static Group groups[] = {
+                &tryGroup<Dispatch, Analysis, G, nbArms, Func, PairsTuple>...};
+        };
+
+        // Tries the arms of one group in order, via a jump table over groups.
+        template <typename Dispatch, typename Analysis, size_t nbArms, typename Func,
+                  typename PairsTuple, size_t... G>
+        constexpr bool tryGroupAt(size_t group, Func const &func, PairsTuple const &pairs,
+                                  std::index_sequence<G...> seq)
+        {
+            using Table = GroupTable<Dispatch, Analysis, nbArms, Func, PairsTuple, decltype(seq)>;
+            return Table::groups[group](func, pairs);
+        }
+
+        template <typename RetType, size_t I, typename PairsTuple, typename ContextT>
+        constexpr RetType executeArm(PairsTuple const &pairs, ContextT &context)
+        {
+            return get<I>(pairs).execute(context);
+        }
+
+        template <typename RetType, size_t I, typename PairsTuple, typename ContextT,
+                  typename Analysis>
+        constexpr auto armHandler() -> RetType (*)(PairsTuple const &, ContextT &)
+        {
+            if constexpr (Analysis::reachable(I))
+            {
+                return &executeArm<RetType, I, PairsTuple, ContextT>;
+            }
+            else
+            {
+                return nullptr;
+            }
+        }
+
+        template <typename Analysis, size_t nbArms>
+        constexpr size_t lastReachableArm()
+        {
+            size_t last = 0;
+            for (size_t i = 0; i < nbArms; ++i)
+            {
+                last = Analysis::reachable(i) ? i : last;
+            }
+            return last;
+        }
+
+        // Invokes the handler of the arm at idx, comparing idx with the
+        // reachable arms from I on so that handlers can be inlined.
+        template <typename RetType, typename Analysis, size_t I, size_t last,
+                  typename PairsTuple, typename ContextT>
+        constexpr RetType executeArmFrom(size_t idx, PairsTuple const &pairs, ContextT &context)
+        {
+            if constexpr (I == last)
+            {
+                static_cast<void>(idx);
+                return get<I>(pairs).execute(context);
+            }
+            else if constexpr (!Analysis::reachable(I))
+            {
+                return executeArmFrom<RetType, Analysis, I + 1, last>(idx, pairs, context);
+            }
+            else
+            {
+                if (idx == I)
+                {
+                    return get<I>(pairs).execute(context);
+                }
+                return executeArmFrom<RetType, Analysis, I + 1, last>(idx, pairs, context);
+            }
+        }
+
+        // Above this many arms, handlers are invoked via a table rather than
+        // compared one by one.
+        constexpr size_t kNB_INLINE_ARMS = 32;
+
+        template <typename RetType, typename PairsTuple, size_t... I, typename ContextT>
+        constexpr RetType executeArmAt(size_t idx, PairsTuple const &pairs,
+                                       std::index_sequence<I...>, ContextT &context)
+        {
+            if constexpr ((isConstantV<typename std::decay_t<
+                               std::tuple_element_t<I, PairsTuple>>::HandlerT> &&
+                           ...) &&
+                          std::is_scalar_v<RetType>)
+            {
+                // Constant results, looked up without branches.
+                static_cast<void>(context);
+                RetType const results[] = {static_cast<RetType>(get<I>(pairs).execute())...};
+                return results[idx];
+            }
+            else
+            {
+                // Unreachable arms are left out.
+                using Analysis = ArmAnalysis<
+                    std::decay_t<std::tuple_element_t<I, PairsTuple>>...>;
+                constexpr auto nbArms = sizeof...(I);
+                if constexpr (nbArms <= kNB_INLINE_ARMS)
+                {
+                    return executeArmFrom<RetType, Analysis, 0,
+                                          lastReachableArm<Analysis, nbArms>()>(idx, pairs,
+                                                                                context);
+                }
+                else if constexpr (Analysis::allReachable())
+                {
+                    using Handler = RetType (*)(PairsTuple const &, ContextT &);
+                    constexpr Handler handlers[] = {
+                        &executeArm<RetType, I, PairsTuple, ContextT>...};
+                    return handlers[idx](pairs, context);
+                }
+                else
+                {
+                    using Handler = RetType (*)(PairsTuple const &, ContextT &);
+                    constexpr Handler handlers[] = {
+                        armHandler<RetType, I, PairsTuple, ContextT, Analysis>()...};
+                    return handlers[idx](pairs, context);
+                }
+            }
+        }
+
+        template <size_t start, typename Analysis, typename Func, typename PairsTuple,
+                  size_t... I>
+        constexpr bool tryReachableArms(Func const &func, PairsTuple const &pairs,
+                                        std::index_sequence<I...>)
+        {
+            return (tryArmIf<Analysis::reachable(start + I)>(func, get<start + I>(pairs),
+                                                              start + I) ||
+                    ...);
+        }
+
+        template <size_t start, typename Analysis, typename Func, typename PairsTuple,
+                  size_t... I>
+        constexpr bool tryArms(Func const &func, PairsTuple const &pairs,
+                               std::index_sequence<I...> seq)
+        {
+            if constexpr (Analysis::allReachable())
+            {
+                return (func(get<start + I>(pairs), start + I) || ...);
+            }
+            else
+            {
+                return tryReachableArms<start, Analysis>(func, pairs, seq);
+            }
+        }
+
+        // Compile-time dispatch strategies over the arms of one match.
+        template <typename Value, typename... PatternPairs>
+        class ArmDispatch
+        {
+            constexpr static auto nbArms = sizeof...(PatternPairs);
+
+        public:
+            using Analysis = ArmAnalysis<PatternPairs...>;
+            constexpr static auto nbLiterals = nbLeading<IsLiteral, PatternPairs...>();
+            using LiteralDispatchT =
+                LiteralDispatch<std::decay_t<Value>,
+                                typename LeadingPatterns<nbLiterals, PatternPairs...>::type>;
+            constexpr static auto nbStrings = nbLeading<IsStringLiteral, PatternPairs...>();
+            using StringDispatchT =
+                StringDispatch<std::decay_t<Value>,
+                               typename LeadingPatterns<nbStrings, PatternPairs...>::type>;
+            constexpr static auto nbIntervals = nbLeading<IsInterval, PatternPairs...>();
+            using IntervalDispatchT =
+                IntervalDispatch<std::decay_t<Value>,
+                                 typename LeadingPatterns<nbIntervals, PatternPairs...>::type>;
+            // Leading arms with keys looked up at once, and how to look them up.
+            constexpr static auto nbKeyed = LiteralDispatchT::enabled    ? nbLiterals
+                                            : StringDispatchT::enabled   ? nbStrings
+                                            : IntervalDispatchT::enabled ? nbIntervals
+                                                                         : 0;
+            using KeyDispatchT = std::conditional_t<
+                LiteralDispatchT::enabled, LiteralDispatchT,
+                std::conditional_t<StringDispatchT::enabled, StringDispatchT,
+                                   IntervalDispatchT>>;
+
+        private:
+            constexpr static auto nbAs = nbLeading<IsAs, PatternPairs...>();
+            using VariantDispatchT =
+                VariantDispatch<std::decay_t<Value>,
+                                typename LeadingPatterns<nbAs, PatternPairs...>::type>;
+            using HierarchyDispatchT =
+                HierarchyDispatch<std::decay_t<Value>,
+                                  typename LeadingPatterns<nbAs, PatternPairs...>::type>;
+            using AnyDispatchT =
+                AnyDispatch<std::decay_t<Value>,
+                            typename LeadingPatterns<nbAs, PatternPairs...>::type>;
+
+        public:
+            // Tries arms in order, skipping those known not to match, after
+            // literal arms have been looked up. Type switches over class
+            // hierarchies are only worth their table for kept arms.
+            template <bool kept, typename Func, typename PairsTuple>
+            constexpr static bool tryArms(Value const &value, Func const &func,
+                                          PairsTuple const &pairs)
+            {
+                if constexpr (KeyDispatchT::enabled)
+                {
+                    static_cast<void>(value);
+                    return impl::tryArms<nbKeyed, Analysis>(
+                        func, pairs, std::make_index_sequence<nbArms - nbKeyed>{});
+                }
+                else if constexpr (VariantDispatchT::enabled)
+                {
+                    return tryGroupAt<VariantDispatchT, Analysis, nbAs>(
+                               VariantDispatchT::lookup(value), func, pairs,
+                               std::make_index_sequence<VariantDispatchT::nbGroups>{}) ||
+                           impl::tryArms<nbAs, Analysis>(func, pairs,
+                                               std::make_index_sequence<nbArms - nbAs>{});
+                }
+                else if constexpr (kept && HierarchyDispatchT::enabled)
+                {
+                    return tryArmsFrom<Analysis>(HierarchyDispatchT::lookup(value), func, pairs,
+                                                 std::make_index_sequence<nbArms>{});
+                }
+                else if constexpr (AnyDispatchT::enabled)
+                {
+                    return tryGroupIn<AnyDispatchT, Analysis>(
+                               AnyDispatchT::lookup(value), func, pairs,
+                               std::make_index_sequence<nbAs>{}) ||
+                           impl::tryArms<nbAs, Analysis>(func, pairs,
+                                               std::make_index_sequence<nbArms - nbAs>{});
+                }
+                else
+                {
+                    static_cast<void>(value);
+                    return impl::tryArms<0, Analysis>(func, pairs, std::make_index_sequence<nbArms>{});
+                }
+            }
+        };
+
+        // The result of a match once the arm at idx, if any, is known to match,
+        // with the values it captured in context. Results are returned from the
+        // handler as is, so that they are built in place. Exhaustive matches
+        // have no no-match path.
+        template <bool tryOnly, typename RetType, bool exhaustive = false, typename PairsTuple,
+                  size_t... I, typename ContextT>
+        constexpr decltype(auto) finishMatch(bool matched, size_t idx, PairsTuple const &pairs,
+                                             std::index_sequence<I...> seq, ContextT &context)
+        {
+            if constexpr (std::is_same_v<RetType, void>)
+            {
+                if (matched)
+                {
+                    executeArmAt<RetType>(idx, pairs, seq, context);
+                }
+                if constexpr (tryOnly)
+                {
+                    return matched;
+                }
+            }
+            else if constexpr (tryOnly)
+            {
+                using ResultT = std::optional<std::conditional_t<
+                    std::is_reference_v<RetType>,
+                    std::reference_wrapper<std::remove_reference_t<RetType>>, RetType>>;
+                return matched ? ResultT{executeArmAt<RetType>(idx, pairs, seq, context)} : ResultT{};
+            }
+            else
+            {
+                if (!matched)
+                {
+                    if constexpr (exhaustive)
+                    {
+                        MATCHIT_UNREACHABLE("Error: exhaustive match got no patterns matched!");
+                    }
+                    else
+                    {
+                        MATCHIT_FAIL("Error: no patterns got matched!");
+                    }
+                }
+                return executeArmAt<RetType>(idx, pairs, seq, context);
+            }
+        }
+
+        // Ids are left bound after the handler of the last match over the same
+        // arms.
+        template <typename PairsTuple, size_t... I>
+        constexpr void resetIds(PairsTuple const &pairs, std::index_sequence<I...>)
+        {
+            (processId(get<I>(pairs).pattern(), 0, IdProcess::kCANCEL), ...);
+        }
+
+        // Matches against arms held in a tuple, with prepared the result of
+        // prepareArms on them, or Unprepared. With tryOnly, mismatching all
+        // patterns is not an error: expressions return an empty std::optional
+        // and statements return false.
+        template <bool tryOnly, typename Policy, typename Value, typename... PatternPairs,
+                  typename PairsTuple, typename Prepared>
+        constexpr decltype(auto) matchPairs(Value &&value, PairsTuple const &pairs,
+                                            Prepared const &prepared)
+        {
+            using RetType = typename PatternPairsRetType<PatternPairs...>::RetType;
+            using Dispatch = ArmDispatch<Value, PatternPairs...>;
+            using KeyDispatchT = typename Dispatch::KeyDispatchT;
+            constexpr auto nbKeyed = Dispatch::nbKeyed;
+            constexpr auto nbArms = sizeof...(PatternPairs);
+            constexpr auto kept = !std::is_same_v<Prepared, Unprepared>;
+            using ContextT = typename ContextTrait<Value, PatternPairs...>::ContextT;
+#ifdef MATCHIT_CHECK_REACHABLE
+            static_assert(Dispatch::Analysis::allReachable(),
+                          "Some arms are subsumed by earlier ones and never taken.");
+#endif
+            constexpr auto instrumented = isInstrumentedV<Policy>;
+            if constexpr (instrumented)
+            {
+                Policy::enter(nbArms);
+            }
+
+            if constexpr (KeyDispatchT::enabled)
+            {
+                auto const idx = KeyDispatchT::lookup(value, pairs, prepared);
+                if (idx < nbKeyed)
+                {
+                    if constexpr (instrumented)
+                    {
+                        Policy::attempt(idx);
+                        Policy::hit(idx);
+                    }
+                    // Keyed arms capture nothing.
+                    auto keyContext = Context<0, 0>{};
+                    return finishMatch<tryOnly, RetType>(
+                        true, idx, pairs, std::make_index_sequence<nbKeyed>{}, keyContext);
+                }
+            }
+            else
+            {
+                static_cast<void>(prepared);
+            }
+
+            resetIds(pairs, std::make_index_sequence<nbArms>{});
+            // Kept until the handler returns, as Ids may refer to values in
+            // them. Each arm reuses the context from the start.
+            auto memo = MemoT<Value, PatternPairs...>{};
+            auto context = makeContext<ContextT, instrumented>(memo);
+            size_t idx = nbArms;
+            bool const matched = Dispatch::template tryArms<kept>(
+                value, [&](auto const &pattern, size_t i) constexpr->bool
+                {
+                    context.rewind();
+                    if constexpr (instrumented)
+                    {
+                        Policy::attempt(i);
+                        context.clearMiss();
+                    }
+                    if (pattern.matchValue(std::forward<Value>(value), context))
+                    {
+                        if constexpr (instrumented)
+                        {
+                            Policy::hit(i);
+                        }
+                        idx = i;
+                        return true;
+                    }
+                    if constexpr (instrumented)
+                    {
+                        Policy::miss(i, context.missDepth());
+                    }
+                    return false;
+                },
+                pairs);
+            if constexpr (instrumented)
+            {
+                if (!matched)
+                {
+                    Policy::noMatch();
+                }
+            }
+            constexpr auto covered = coverage<Value, PatternPairs...>();
+            if constexpr (!tryOnly && covered == Coverage::kALTERNATIVES)
+            {
+                // Valueless variants are matched by no as<T> arm.
+                if (!matched && value.valueless_by_exception())
+                {
+                    MATCHIT_FAIL("Error: no patterns got matched!");
+                }
+            }
+            // Enum values of no enumerator are valid, and fail as usual.
+            return finishMatch<tryOnly, RetType,
+                               covered == Coverage::kTOTAL || covered == Coverage::kALTERNATIVES>(
+                matched, idx, pairs, std::make_index_sequence<nbArms>{}, context);
+        }
+
+        template <bool tryOnly, typename Policy, typename Value, typename... PatternPairs>
+        constexpr decltype(auto) matchPatterns(Value &&value, PatternPairs const &...patterns)
+        {
+            auto const pairs = std::forward_as_tuple(patterns...);
+            return matchPairs<tryOnly, Policy, Value, PatternPairs...>(std::forward<Value>(value),
+                                                                       pairs, Unprepared{});
+        }
+
+        // Whether a pattern can be checked against a value without branches or
+        // bindings, so that checks over many values can be vectorized.
+        template <typename Pattern, typename Value, typename = void>
+        class BranchFree
+        {
+        public:
+            constexpr static auto enabled = false;
+        };
+
+        template <typename Value>
+        class BranchFree<Wildcard, Value>
+        {
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(Wildcard const &, Value const &) { return true; }
+        };
+
+        template <auto v, typename Value>
+        class BranchFree<Literal<v>, Value, std::enable_if_t<std::is_arithmetic_v<Value>>>
+        {
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(Literal<v> const &, Value const &value)
+            {
+                return v == value;
+            }
+        };
+
+        template <typename Pattern, typename Value>
+        class BranchFree<Pattern, Value,
+                         std::enable_if_t<std::is_arithmetic_v<Pattern> &&
+                                          std::is_arithmetic_v<Value>>>
+        {
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(Pattern const &pattern, Value const &value)
+            {
+                return pattern == value;
+            }
+        };
+
+        template <typename T, typename Value>
+        class BranchFree<Interval<T>, Value, std::enable_if_t<std::is_arithmetic_v<Value>>>
+        {
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(Interval<T> const &intervalPat, Value const &value)
+            {
+                return intervalPat.aboveLower(value) & intervalPat.belowUpper(value);
+            }
+        };
+
+        template <typename... Patterns, typename Value>
+        class BranchFree<
+            Or<Patterns...>, Value,
+            std::enable_if_t<(BranchFree<InternalPatternT<Patterns>, Value>::enabled && ...)>>
+        {
+            template <size_t... I>
+            constexpr static bool testImpl(Or<Patterns...> const &orPat, Value const &value,
+                                           std::index_sequence<I...>)
+            {
+                return (BranchFree<InternalPatternT<Patterns>, Value>::test(
+                            get<I>(orPat.patterns()), value) |
+                        ...);
+            }
+
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(Or<Patterns...> const &orPat, Value const &value)
+            {
+                return testImpl(orPat, value, std::index_sequence_for<Patterns...>{});
+            }
+        };
+
+        template <typename... Patterns, typename Value>
+        class BranchFree<
+            And<Patterns...>, Value,
+            std::enable_if_t<(BranchFree<InternalPatternT<Patterns>, Value>::enabled && ...)>>
+        {
+            template <size_t... I>
+            constexpr static bool testImpl(And<Patterns...> const &andPat, Value const &value,
+                                           std::index_sequence<I...>)
+            {
+                return (BranchFree<InternalPatternT<Patterns>, Value>::test(
+                            get<I>(andPat.patterns()), value) &
+                        ...);
+            }
+
+        public:
+            constexpr static auto enabled = true;
+            constexpr static bool test(And<Patterns...> const &andPat, Value const &value)
+            {
+                return testImpl(andPat, value, std::index_sequence_for<Patterns...>{});
+            }
+        };
+
+        template <typename Value, typename... PatternPairs>
+        constexpr auto branchFreePatternsV =
+            (BranchFree<typename PatternPairs::PatternT, Value>::enabled && ...);
+
+        // Also requiring constant handlers, so that results can be blended.
+        template <typename Value, typename... PatternPairs>
+        constexpr auto branchFreeArmsV =
+            branchFreePatternsV<Value, PatternPairs...> &&
+            (isConstantV<typename PatternPairs::HandlerT> && ...) &&
+            std::is_scalar_v<typename PatternPairsRetType<PatternPairs...>::RetType>;
+
+        // Selects x for the values matching the pattern, keeps result otherwise.
+        template <typename Value, typename Pattern, typename T>
+        constexpr void blendArm(Value const &value, Pattern const &pattern, T const &x,
+                                T &result, bool &matched)
+        {
+            bool const m = BranchFree<Pattern, Value>::test(pattern, value);
+            result = m ? x : result;
+            matched |= m;
+        }
+
+        // Arms are blended from the last one so that earlier arms take
+        // precedence. Patterns are copied locally to tell compilers they do not
+        // alias the output.
+        template <typename T, typename Value, typename Out, typename PairsTuple, size_t... I>
+        constexpr bool blendBatch(Value const *in, Out *out, size_t size,
+                                  PairsTuple const &pairs, T const (&xs)[sizeof...(I)],
+                                  T const &fallback, std::index_sequence<I...>)
+        {
+            constexpr auto last = sizeof...(I) - 1;
+            auto const patterns = std::make_tuple(get<I>(pairs).pattern()...);
+            bool allMatched = true;
+            for (size_t i = 0; i < size; ++i)
+            {
+                auto const value = in[i];
+                auto result = fallback;
+                bool matched = false;
+                (blendArm(value, get<last - I>(patterns), xs[last - I], result, matched), ...);
+                out[i] = result;
+                allMatched &= matched;
+            }
+            return allMatched;
+        }
+
+        template <typename Value, typename IndexT, typename PairsTuple, size_t... I>
+        constexpr void blendIndices(Value const *in, IndexT *out, size_t size,
+                                    PairsTuple const &pairs, std::index_sequence<I...> seq)
+        {
+            IndexT const indices[] = {static_cast<IndexT>(I)...};
+            static_cast<void>(blendBatch(in, out, size, pairs, indices,
+                                         static_cast<IndexT>(sizeof...(I)), seq));
+        }
+
+        template <typename Value, typename... PatternPairs, typename PairsTuple, size_t... I>
+        constexpr size_t matchArmIndex(Value const &value, PairsTuple const &pairs,
+                                       std::index_sequence<I...>)
+        {
+            using ContextT = typename ContextTrait<Value const &, PatternPairs...>::ContextT;
+            auto idx = sizeof...(I);
+            ContextT context{};
+            auto const func = [&](auto const &pattern, size_t i)
+            {
+                context.rewind();
+                if (pattern.matchValue(value, context))
+                {
+                    processId(pattern.pattern(), 0, IdProcess::kCANCEL);
+                    idx = i;
+                    return true;
+                }
+                return false;
+            };
+            static_cast<void>((func(get<I>(pairs), I) || ...));
+            return idx;
+        }
+
+        // Matches each value of the contiguous range in, writing the results to
+        // the same positions of out.
+        template <typename In, typename Out, typename... PatternPairs>
+        constexpr void matchBatch(In const &in, Out &&out, PatternPairs const &...patterns)
+        {
+            using ValueT = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(in))>>;
+            using RetType = typename PatternPairsRetType<PatternPairs...>::RetType;
+            auto const size = static_cast<size_t>(std::size(in));
+            assert(static_cast<size_t>(std::size(out)) >= size);
+            auto const pairs = std::forward_as_tuple(patterns...);
+            if constexpr (branchFreeArmsV<ValueT, PatternPairs...>)
+            {
+                RetType const results[] = {static_cast<RetType>(patterns.execute())...};
+                auto const allMatched =
+                    blendBatch(std::data(in), std::data(out), size, pairs, results, RetType{},
+                               std::index_sequence_for<PatternPairs...>{});
+                if (!allMatched)
+                {
+                    MATCHIT_FAIL("Error: no patterns got matched!");
+                }
+            }
+            else
+            {
+                auto const prepared = prepareArms<PatternPairs...>(pairs);
+                for (size_t i = 0; i < size; ++i)
+                {
+                    std::data(out)[i] =
+                        matchPairs<false, NoInstrumentation, ValueT const &, PatternPairs...>(
+                            std::data(in)[i], pairs, prepared);
+                }
+            }
+        }
+
+        // Writes the index of the first arm matching each value, or the number
+        // of arms if none matches. Handlers are not invoked.
+        template <typename In, typename Out, typename... PatternPairs>
+        constexpr void matchBatchIndex(In const &in, Out &&out, PatternPairs const &...patterns)
+        {
+            using ValueT = std::remove_cv_t<std::remove_reference_t<decltype(*std::data(in))>>;
+            using IndexT = std::remove_reference_t<decltype(*std::data(out))>;
+            auto const size = static_cast<size_t>(std::size(in));
+            assert(static_cast<size_t>(std::size(out)) >= size);
+            auto const pairs = std::forward_as_tuple(patterns...);
+            if constexpr (branchFreePatternsV<ValueT, PatternPairs...>)
+            {
+                blendIndices(std::data(in), std::data(out), size, pairs,
+                             std::index_sequence_for<PatternPairs...>{});
+            }
+            else
+            {
+                for (size_t i = 0; i < size; ++i)
+                {
+                    std::data(out)[i] = static_cast<IndexT>(matchArmIndex<ValueT, PatternPairs...>(
+                        std::data(in)[i], pairs, std::index_sequence_for<PatternPairs...>{}));
+                }
+            }
+        }
+
+        // Matcher trying its leading arms in order of their recent hits, when
+        // they are disjoint so that the order does not change the result. Arms
+        // after them are tried in order afterwards. Leading arms looked up via
+        // a KeyDispatch, i.e. a jump table, a binary search or a switch on
+        // string lengths, are not reordered, as the order does not change
+        // the cost of these lookups.
+        template <typename... PatternPairs>
+        class AdaptiveMatcher
+        {
+            using PairsT = std::tuple<PatternPairs...>;
+            using RetType = typename PatternPairsRetType<PatternPairs...>::RetType;
+            constexpr static auto nbArms = sizeof...(PatternPairs);
+            // Orders are packed in 4 bits per arm.
+            constexpr static auto nbKeys =
+                std::min<size_t>(nbLeading<IsDisjointKey, PatternPairs...>(), 16);
+            // Hits of one call in kSAMPLE are recorded, and the arms are
+            // reordered every kPERIOD recorded hits.
+            constexpr static uint32_t kSAMPLE = 16;
+            constexpr static uint32_t kPERIOD = 64;
+            constexpr static size_t kCACHE_LINE = 64;
+
+            template <size_t... I>
+            static auto prepareRest(PairsT const &pairs, std::index_sequence<I...>)
+            {
+                return prepareArms<std::tuple_element_t<nbKeys + I, PairsT>...>(
+                    std::forward_as_tuple(get<nbKeys + I>(pairs)...));
+            }
+
+            using PreparedT = decltype(prepareArms<PatternPairs...>(std::declval<PairsT const &>()));
+            using RestPreparedT = decltype(prepareRest(
+                std::declval<PairsT const &>(), std::make_index_sequence<nbArms - nbKeys>{}));
+
+            PairsT mPairs;
+            PreparedT mPrepared;
+            RestPreparedT mRestPrepared;
+            bool mAdaptive;
+            mutable std::atomic<uint64_t> mOrder;
+            // Apart from the fields read on every call, and from each other.
+            alignas(kCACHE_LINE) mutable std::atomic<uint32_t> mSamples{};
+            alignas(kCACHE_LINE) mutable std::array<std::atomic<uint32_t>, nbKeys> mHits{};
+
+            constexpr static uint64_t identity()
+            {
+                uint64_t order = 0;
+                for (size_t i = 0; i < nbKeys; ++i)
+                {
+                    order |= static_cast<uint64_t>(i) << (4 * i);
+                }
+                return order;
+            }
+
+            // Whether to record the hit of this call. Drawn per thread, so that
+            // concurrent callers only share the counters on recorded hits.
+            static bool sampled()
+            {
+                thread_local uint32_t sState = 0x9E3779B9U;
+                sState ^= sState << 13;
+                sState ^= sState >> 17;
+                sState ^= sState << 5;
+                return sState <= std::numeric_limits<uint32_t>::max() / kSAMPLE;
+            }
+
+            template <size_t I, typename Value>
+            static bool tryKey(Value const &value, PairsT const &pairs)
+            {
+                Context<0, 0> context{};
+                return get<I>(pairs).matchValue(value, context);
+            }
+
+            // Probes are compared inline rather than called through a table,
+            // so that they can be inlined.
+            template <typename Value, size_t... I>
+            bool tryKeyAt(size_t key, Value const &value, std::index_sequence<I...>) const
+            {
+                auto matched = false;
+                static_cast<void>(
+                    ((key == I && (matched = tryKey<I>(value, mPairs), true)) || ...));
+                return matched;
+            }
+
+            template <typename Value, size_t... I>
+            size_t findKey(Value const &value, std::index_sequence<I...> keys) const
+            {
+                auto const order = mOrder.load(std::memory_order_relaxed);
+                for (size_t i = 0; i < nbKeys; ++i)
+                {
+                    auto const key = static_cast<size_t>((order >> (4 * i)) & 0xF);
+                    if (tryKeyAt(key, value, keys))
+                    {
+                        return key;
+                    }
+                }
+                return nbKeys;
+            }
+
+            // Hottest arms first. Counts are halved so that the order follows
+            // shifts in the values matched.
+            void reorder() const
+            {
+                std::array<uint32_t, nbKeys> hits{};
+                std::array<size_t, nbKeys> keys{};
+                for (size_t i = 0; i < nbKeys; ++i)
+                {
+                    hits[i] = mHits[i].load(std::memory_order_relaxed);
+                    mHits[i].store(hits[i] / 2, std::memory_order_relaxed);
+                    keys[i] = i;
+                }
+                std::stable_sort(keys.begin(), keys.end(),
+                                 [&](size_t l, size_t r) { return hits[l] > hits[r]; });
+                uint64_t order = 0;
+                for (size_t i = 0; i < nbKeys; ++i)
+                {
+                    order |= static_cast<uint64_t>(keys[i]) << (4 * i);
+                }
+                mOrder.store(order, std::memory_order_relaxed);
+            }
+
+            template <bool tryOnly, typename ResultT, typename Value, size_t... I>
+            decltype(auto) matchRest(Value &&value, std::index_sequence<I...>) const
+            {
+                auto const rest = std::forward_as_tuple(get<nbKeys + I>(mPairs)...);
+                return static_cast<ResultT>(
+                    matchPairs<tryOnly, NoInstrumentation, Value,
+                               std::tuple_element_t<nbKeys + I, PairsT>...>(
+                        std::forward<Value>(value), rest, mRestPrepared));
+            }
+
+            template <bool tryOnly, typename Value>
+            decltype(auto) apply(Value &&value) const
+            {
+                using KeyDispatchT = typename ArmDispatch<Value, PatternPairs...>::KeyDispatchT;
+                if constexpr (KeyDispatchT::enabled || nbKeys == 0)
+                {
+                    // Looking keys up does not depend on the order of the arms.
+                    return matchPairs<tryOnly, NoInstrumentation, Value, PatternPairs...>(
+                        std::forward<Value>(value), mPairs, mPrepared);
+                }
+                else
+                {
+                    constexpr auto keys = std::make_index_sequence<nbKeys>{};
+                    auto keyContext = Context<0, 0>{};
+                    using ResultT =
+                        decltype(finishMatch<tryOnly, RetType>(true, 0, mPairs, keys, keyContext));
+                    auto const key = findKey(value, keys);
+                    if (key < nbKeys)
+                    {
+                        if (mAdaptive && sampled())
+                        {
+                            mHits[key].fetch_add(1, std::memory_order_relaxed);
+                            if (mSamples.fetch_add(1, std::memory_order_relaxed) % kPERIOD ==
+                                kPERIOD - 1)
+                            {
+                                reorder();
+                            }
+                        }
+                        return finishMatch<tryOnly, RetType>(true, key, mPairs, keys, keyContext);
+                    }
+                    if constexpr (nbKeys == nbArms)
+                    {
+                        return finishMatch<tryOnly, RetType,
+                                           coverage<Value, PatternPairs...>() ==
+                                               Coverage::kTOTAL>(false, key, mPairs, keys,
+                                                                 keyContext);
+                    }
+                    else
+                    {
+                        return matchRest<tryOnly, ResultT>(
+                            std::forward<Value>(value),
+                            std::make_index_sequence<nbArms - nbKeys>{});
+                    }
+                }
+            }
+
+        public:
+            explicit AdaptiveMatcher(PatternPairs const &...patterns)
+                : mPairs{patterns...}, mPrepared{prepareArms<PatternPairs...>(mPairs)},
+                  mRestPrepared{prepareRest(mPairs, std::make_index_sequence<nbArms - nbKeys>{})},
+                  mAdaptive{nbKeys > 1 &&
+                            analyzeArms(mPairs, std::make_index_sequence<nbArms>{}).disjoint(nbKeys)},
+                  mOrder{identity()}
+            {
+            }
+            AdaptiveMatcher(AdaptiveMatcher const &) = delete;
+            AdaptiveMatcher &operator=(AdaptiveMatcher const &) = delete;
+
+            template <typename Value>
+            decltype(auto) operator()(Value &&value) const
+            {
+                return apply<false>(std::forward<Value>(value));
+            }
+            // Like operator(), but mismatching all patterns gives an empty
+            // std::optional (or false for statements) instead of an error.
+            template <typename Value>
+            decltype(auto) tryMatch(Value &&value) const
+            {
+                return apply<true>(std::forward<Value>(value));
+            }
+            // Whether the leading arms are reordered, i.e. they are known to be
+            // disjoint.
+            bool adaptive() const { return mAdaptive; }
+        };
+
+        // Like matcher, for values matched many times in a process, with the
+        // hottest of the leading literal, value and interval arms tried first.
+        template <typename... PatternPairs>
+        auto adaptiveMatcher(PatternPairs const &...patterns)
+        {
+            return AdaptiveMatcher<PatternPairs...>{patterns...};
+        }
+
+        // Types of the Ids in a pattern, in order and with repetitions.
+        template <typename Pattern>
+        class IdTuple
+        {
+        public:
+            using type = std::tuple<>;
+        };
+
+        template <typename Pattern>
+        using IdTupleT = typename IdTuple<Pattern>::type;
+
+        template <typename Type>
+        class IdTuple<Id<Type>>
+        {
+        public:
+            using type = std::tuple<Type>;
+        };
+
+        template <typename Type>
+        class IdTuple<OooBinder<Type>> : public IdTuple<Id<Type>>
+        {
+        };
+
+        template <typename Unary, typename Pattern>
+        class IdTuple<App<Unary, Pattern>> : public IdTuple<Pattern>
+        {
+        };
+
+        template <typename Pattern, typename Pred>
+        class IdTuple<PostCheck<Pattern, Pred>> : public IdTuple<Pattern>
+        {
+        };
+
+        template <typename Pattern>
+        class IdTuple<Not<Pattern>> : public IdTuple<Pattern>
+        {
+        };
+
+        template <typename... Patterns>
+        class IdTuple<And<Patterns...>>
+        {
+        public:
+            using type = decltype(std::tuple_cat(std::declval<IdTupleT<Patterns>>()...));
+        };
+
+        template <typename... Patterns>
+        class IdTuple<Or<Patterns...>> : public IdTuple<And<Patterns...>>
+        {
+        };
+
+        template <typename... Patterns>
+        class IdTuple<Ds<Patterns...>> : public IdTuple<And<Patterns...>>
+        {
+        };
+
+        // Room for an IdBlock per Id of the types, ahead of the frame using it.
+        template <typename... Types>
+        class IdFrameBlocks
+        {
+        protected:
+            constexpr static auto kALIGN = std::max({alignof(IdBlock<Types>)..., size_t{1}});
+            constexpr static auto kSTRIDE =
+                (std::max({sizeof(IdBlock<Types>)..., size_t{1}}) + kALIGN - 1) / kALIGN * kALIGN;
+
+            std::array<void const *, sizeof...(Types)> mKeyArray;
+            std::array<void (*)(void *), sizeof...(Types)> mDestroyArray;
+            alignas(kALIGN) std::array<unsigned char, sizeof...(Types) * kSTRIDE> mBlockArray;
+        };
+
+        template <typename Tuple>
+        class IdFrameStorage;
+
+        template <typename... Types>
+        class IdFrameStorage<std::tuple<Types...>> : private IdFrameBlocks<Types...>,
+                                                     public IdFrame
+        {
+            using BlocksT = IdFrameBlocks<Types...>;
+
+        public:
+            IdFrameStorage()
+                : IdFrame{this->mKeyArray.data(), this->mDestroyArray.data(),
+                          this->mBlockArray.data(), BlocksT::kSTRIDE, sizeof...(Types)}
+            {
+            }
+        };
+
+        // Matcher that can be called from many threads at once, and
+        // recursively from its handlers. The Ids in its arms are bound in a
+        // frame on the stack of each call rather than in the Ids themselves,
+        // and handlers read them from there. Such Ids are meant to be used in
+        // shared matchers only.
+        template <typename... PatternPairs>
+        class SharedMatcher
+        {
+            using PairsT = std::tuple<PatternPairs...>;
+            using PreparedT = decltype(prepareArms<PatternPairs...>(std::declval<PairsT const &>()));
+            using FrameT = IdFrameStorage<decltype(std::tuple_cat(
+                std::declval<IdTupleT<typename PatternPairs::PatternT>>()...))>;
+            constexpr static auto nbArms = sizeof...(PatternPairs);
+
+            PairsT mPairs;
+            PreparedT mPrepared;
+
+            template <size_t... I>
+            void processIds(IdProcess idProcess, std::index_sequence<I...>) const
+            {
+                (processId(get<I>(mPairs).pattern(), 0, idProcess), ...);
+            }
+
+            template <bool tryOnly, typename... Values>
+            decltype(auto) apply(Values &&...values) const
+            {
+                // Kept until the handler returns.
+                FrameT frame{};
+                processIds(IdProcess::kFRAME, std::make_index_sequence<nbArms>{});
+                if constexpr (sizeof...(Values) == 1)
+                {
+                    return matchPairs<tryOnly, NoInstrumentation, Values..., PatternPairs...>(
+                        std::forward<Values>(values)..., mPairs, mPrepared);
+                }
+                else
+                {
+                    auto result = std::forward_as_tuple(std::forward<Values>(values)...);
+                    return matchPairs<tryOnly, NoInstrumentation, decltype(result),
+                                      PatternPairs...>(std::move(result), mPairs, mPrepared);
+                }
+            }
+
+        public:
+            explicit SharedMatcher(PatternPairs const &...patterns)
+                : mPairs{patterns...}, mPrepared{prepareArms<PatternPairs...>(mPairs)}
+            {
+                processIds(IdProcess::kSHARE, std::make_index_sequence<nbArms>{});
+            }
+
+            template <typename... Values>
+            decltype(auto) operator()(Values &&...values) const
+            {
+                return apply<false>(std::forward<Values>(values)...);
+            }
+            // Like operator(), but mismatching all patterns gives an empty
+            // std::optional (or false for statements) instead of an error.
+            template <typename... Values>
+            decltype(auto) tryMatch(Values &&...values) const
+            {
+                return apply<true>(std::forward<Values>(values)...);
+            }
+        };
+
+        // Like matcher, for matchers with Ids shared by many threads, e.g. in
+        // static variables.
+        template <typename... PatternPairs>
+        auto sharedMatcher(PatternPairs const &...patterns)
+        {
+            return SharedMatcher<PatternPairs...>{patterns...};
         }
 
     } // namespace impl
 
     // export symbols
     using impl::_;
+    using impl::adaptiveMatcher;
     using impl::and_;
     using impl::app;
+    using impl::capture;
     using impl::ds;
+    using impl::exhaustive;
     using impl::Id;
+    using impl::InputRange;
+    using impl::inputRange;
+    using impl::lit;
+    using impl::matchBatch;
+    using impl::matchBatchIndex;
     using impl::meet;
     using impl::not_;
     using impl::ooo;
     using impl::or_;
     using impl::pattern;
+    using impl::sharedMatcher;
     using impl::Subrange;
     using impl::SubrangeT;
     using impl::when;
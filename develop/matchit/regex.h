@@ -0,0 +1,988 @@
+#ifndef MATCHIT_REGEX_H
+#define MATCHIT_REGEX_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+// The most DFA states a regex pattern is compiled to. Regexes needing more are
+// matched by simulating their NFA, with the captures.
+#if !defined(MATCHIT_REGEX_DFA_STATES)
+#define MATCHIT_REGEX_DFA_STATES 256
+#endif // !defined(MATCHIT_REGEX_DFA_STATES)
+
+namespace matchit
+{
+  namespace impl
+  {
+    // Called when compiling an invalid regex, so that the compiler reports the
+    // reason instead of a constant.
+    inline void invalidRegex(char const * /* reason */) {}
+
+    class ByteSet
+    {
+    public:
+      constexpr void add(size_t byte) { mWords[byte / 64] |= uint64_t{1} << (byte % 64); }
+      constexpr void add(size_t first, size_t last)
+      {
+        for (auto byte = first; byte <= last; ++byte)
+        {
+          add(byte);
+        }
+      }
+      constexpr void add(ByteSet const &other)
+      {
+        for (size_t i = 0; i < mWords.size(); ++i)
+        {
+          mWords[i] |= other.mWords[i];
+        }
+      }
+      constexpr void flip()
+      {
+        for (auto &word : mWords)
+        {
+          word = ~word;
+        }
+      }
+      constexpr bool contains(size_t byte) const
+      {
+        return ((mWords[byte / 64] >> (byte % 64)) & 1U) != 0;
+      }
+
+    private:
+      std::array<uint64_t, 4> mWords{};
+    };
+
+    enum class RegexOp : uint8_t
+    {
+      // Consumes a byte among bytes, then goes to next.
+      kBYTE,
+      // Goes to next, then to other with a lower priority.
+      kSPLIT,
+      kJUMP,
+      // Records the position in the slot other, then goes to next.
+      kSAVE,
+      kMATCH
+    };
+
+    class RegexInst
+    {
+    public:
+      RegexOp op{RegexOp::kMATCH};
+      size_t next{};
+      size_t other{};
+      ByteSet bytes{};
+    };
+
+    // Compiles a regex to the program of a Pike VM, keeping its first capacity
+    // instructions and counting them all.
+    template <size_t capacity>
+    class RegexCompiler
+    {
+      constexpr static size_t many = SIZE_MAX;
+      constexpr static size_t nbBytes = 256;
+
+      class Repeat
+      {
+      public:
+        size_t min;
+        size_t max;
+        bool lazy;
+        size_t end;
+      };
+
+    public:
+      constexpr explicit RegexCompiler(std::string_view re) : mRe{re}
+      {
+        alternation(0, mRe.size());
+        emit(RegexOp::kMATCH);
+      }
+
+      constexpr size_t size() const { return mSize; }
+      constexpr auto const &insts() const { return mInsts; }
+      constexpr size_t nbGroups() const { return groupsBefore(mRe.size()); }
+
+    private:
+      constexpr char at(size_t pos) const { return pos < mRe.size() ? mRe[pos] : '\0'; }
+
+      constexpr size_t emit(RegexOp op, size_t next = 0, size_t other = 0,
+                            ByteSet const &bytes = {})
+      {
+        if constexpr (capacity != 0)
+        {
+          if (mSize < capacity)
+          {
+            mInsts[mSize] = RegexInst{op, next, other, bytes};
+          }
+        }
+        return mSize++;
+      }
+
+      // Prefers enter to exit, or the other way round when lazy.
+      constexpr void setSplit(size_t pc, size_t enter, size_t exit, bool lazy)
+      {
+        if constexpr (capacity != 0)
+        {
+          if (pc < capacity)
+          {
+            mInsts[pc].next = lazy ? exit : enter;
+            mInsts[pc].other = lazy ? enter : exit;
+          }
+        }
+      }
+
+      constexpr void setNext(size_t pc, size_t next)
+      {
+        if constexpr (capacity != 0)
+        {
+          if (pc < capacity)
+          {
+            mInsts[pc].next = next;
+          }
+        }
+      }
+
+      // The end of the character class starting at pos.
+      constexpr size_t classEnd(size_t pos) const
+      {
+        ++pos;
+        if (at(pos) == '^')
+        {
+          ++pos;
+        }
+        if (at(pos) == ']')
+        {
+          invalidRegex("empty character class");
+        }
+        for (; pos < mRe.size(); ++pos)
+        {
+          if (mRe[pos] == '\\')
+          {
+            ++pos;
+          }
+          else if (mRe[pos] == ']')
+          {
+            return pos + 1;
+          }
+        }
+        invalidRegex("missing ] of character class");
+        return mRe.size();
+      }
+
+      // The end of the atom starting at pos.
+      constexpr size_t atomEnd(size_t pos) const
+      {
+        switch (mRe[pos])
+        {
+        case '(':
+        {
+          size_t depth = 0;
+          for (; pos < mRe.size(); ++pos)
+          {
+            auto const c = mRe[pos];
+            if (c == '\\')
+            {
+              ++pos;
+            }
+            else if (c == '[')
+            {
+              pos = classEnd(pos) - 1;
+            }
+            else if (c == '(')
+            {
+              ++depth;
+            }
+            else if (c == ')' && --depth == 0)
+            {
+              return pos + 1;
+            }
+          }
+          invalidRegex("missing )");
+          return mRe.size();
+        }
+        case '[':
+          return classEnd(pos);
+        case '\\':
+          if (pos + 1 == mRe.size())
+          {
+            invalidRegex("trailing \\");
+          }
+          return pos + 2;
+        case ')':
+          invalidRegex("unmatched )");
+          return pos + 1;
+        case '*':
+        case '+':
+        case '?':
+        case '{':
+          invalidRegex("nothing to repeat");
+          return pos + 1;
+        case '^':
+        case '$':
+          invalidRegex("anchors are implicit, the whole value is matched");
+          return pos + 1;
+        default:
+          return pos + 1;
+        }
+      }
+
+      constexpr size_t number(size_t &pos) const
+      {
+        if (at(pos) < '0' || at(pos) > '9')
+        {
+          invalidRegex("missing number of repetitions");
+        }
+        size_t value = 0;
+        for (; at(pos) >= '0' && at(pos) <= '9'; ++pos)
+        {
+          value = value * 10 + static_cast<size_t>(at(pos) - '0');
+        }
+        return value;
+      }
+
+      // The quantifier starting at pos, if any.
+      constexpr Repeat repeat(size_t pos) const
+      {
+        Repeat result{1, 1, false, pos};
+        switch (at(pos))
+        {
+        case '*':
+          result = {0, many, false, pos + 1};
+          break;
+        case '+':
+          result = {1, many, false, pos + 1};
+          break;
+        case '?':
+          result = {0, 1, false, pos + 1};
+          break;
+        case '{':
+        {
+          ++pos;
+          auto const min = number(pos);
+          auto max = min;
+          if (at(pos) == ',')
+          {
+            ++pos;
+            max = at(pos) == '}' ? many : number(pos);
+          }
+          if (at(pos) != '}' || max < min)
+          {
+            invalidRegex("invalid {min,max}");
+          }
+          result = {min, max, false, pos + 1};
+          break;
+        }
+        default:
+          return result;
+        }
+        if (at(result.end) == '?')
+        {
+          result.lazy = true;
+          ++result.end;
+        }
+        return result;
+      }
+
+      // The number of capturing groups opened before end.
+      constexpr size_t groupsBefore(size_t end) const
+      {
+        size_t nb = 0;
+        for (size_t pos = 0; pos < end; ++pos)
+        {
+          auto const c = mRe[pos];
+          if (c == '\\')
+          {
+            ++pos;
+          }
+          else if (c == '[')
+          {
+            pos = classEnd(pos) - 1;
+          }
+          else if (c == '(' && at(pos + 1) != '?')
+          {
+            ++nb;
+          }
+        }
+        return nb;
+      }
+
+      constexpr static size_t escapeByte(char c)
+      {
+        switch (c)
+        {
+        case 'n':
+          return '\n';
+        case 'r':
+          return '\r';
+        case 't':
+          return '\t';
+        case 'f':
+          return '\f';
+        case 'v':
+          return '\v';
+        case '0':
+          return 0;
+        default:
+          if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9'))
+          {
+            invalidRegex("unknown escape");
+          }
+          return static_cast<unsigned char>(c);
+        }
+      }
+
+      constexpr static ByteSet escapeBytes(char c)
+      {
+        ByteSet bytes;
+        switch (c)
+        {
+        case 'd':
+        case 'D':
+          bytes.add('0', '9');
+          break;
+        case 'w':
+        case 'W':
+          bytes.add('a', 'z');
+          bytes.add('A', 'Z');
+          bytes.add('0', '9');
+          bytes.add('_');
+          break;
+        case 's':
+        case 'S':
+          bytes.add('\t', '\r');
+          bytes.add(' ');
+          break;
+        default:
+          bytes.add(escapeByte(c));
+          return bytes;
+        }
+        if (c == 'D' || c == 'W' || c == 'S')
+        {
+          bytes.flip();
+        }
+        return bytes;
+      }
+
+      // Adds the byte or the escaped class at pos, then moves past it. Returns
+      // the byte, or nbBytes for classes.
+      constexpr size_t classAtom(size_t &pos, ByteSet &bytes) const
+      {
+        if (mRe[pos] != '\\')
+        {
+          return static_cast<unsigned char>(mRe[pos++]);
+        }
+        auto const c = mRe[pos + 1];
+        pos += 2;
+        switch (c)
+        {
+        case 'd':
+        case 'D':
+        case 'w':
+        case 'W':
+        case 's':
+        case 'S':
+          bytes.add(escapeBytes(c));
+          return nbBytes;
+        default:
+          return escapeByte(c);
+        }
+      }
+
+      constexpr ByteSet classBytes(size_t begin, size_t end) const
+      {
+        ByteSet bytes;
+        auto pos = begin + 1;
+        auto const negated = at(pos) == '^';
+        if (negated)
+        {
+          ++pos;
+        }
+        auto const last = end - 1;
+        while (pos < last)
+        {
+          auto const first = classAtom(pos, bytes);
+          if (at(pos) == '-' && pos + 1 < last)
+          {
+            ++pos;
+            auto const second = classAtom(pos, bytes);
+            if (first == nbBytes || second == nbBytes || second < first)
+            {
+              invalidRegex("invalid range in character class");
+            }
+            bytes.add(first, second);
+          }
+          else if (first != nbBytes)
+          {
+            bytes.add(first);
+          }
+        }
+        if (negated)
+        {
+          bytes.flip();
+        }
+        return bytes;
+      }
+
+      constexpr void atom(size_t begin, size_t end)
+      {
+        ByteSet bytes;
+        switch (mRe[begin])
+        {
+        case '(':
+          if (at(begin + 1) != '?')
+          {
+            auto const group = groupsBefore(begin);
+            emit(RegexOp::kSAVE, mSize + 1, 2 * group);
+            alternation(begin + 1, end - 1);
+            emit(RegexOp::kSAVE, mSize + 1, 2 * group + 1);
+          }
+          else
+          {
+            if (at(begin + 2) != ':')
+            {
+              invalidRegex("only (?: groups are supported");
+            }
+            alternation(begin + 3, end - 1);
+          }
+          return;
+        case '[':
+          bytes = classBytes(begin, end);
+          break;
+        case '.':
+          bytes.add(0, '\n' - 1);
+          bytes.add('\n' + 1, nbBytes - 1);
+          break;
+        case '\\':
+          bytes = escapeBytes(mRe[begin + 1]);
+          break;
+        default:
+          bytes.add(static_cast<unsigned char>(mRe[begin]));
+          break;
+        }
+        emit(RegexOp::kBYTE, mSize + 1, 0, bytes);
+      }
+
+      constexpr void repeated(size_t begin, size_t end, Repeat const &r)
+      {
+        // The last required copy of a loop is the loop.
+        auto const nbRequired = r.max == many && r.min > 0 ? r.min - 1 : r.min;
+        for (size_t i = 0; i < nbRequired; ++i)
+        {
+          atom(begin, end);
+        }
+        if (r.max == many)
+        {
+          if (r.min > 0)
+          {
+            auto const loop = mSize;
+            atom(begin, end);
+            auto const split = emit(RegexOp::kSPLIT);
+            setSplit(split, loop, split + 1, r.lazy);
+          }
+          else
+          {
+            auto const split = emit(RegexOp::kSPLIT);
+            atom(begin, end);
+            emit(RegexOp::kJUMP, split);
+            setSplit(split, split + 1, mSize, r.lazy);
+          }
+          return;
+        }
+        // Optional copies, all skipping to their end.
+        auto const first = mSize;
+        for (auto i = r.min; i < r.max; ++i)
+        {
+          emit(RegexOp::kSPLIT);
+          atom(begin, end);
+        }
+        if (r.max > r.min)
+        {
+          auto const stride = (mSize - first) / (r.max - r.min);
+          for (auto split = first; split < mSize; split += stride)
+          {
+            setSplit(split, split + 1, mSize, r.lazy);
+          }
+        }
+      }
+
+      constexpr void sequence(size_t begin, size_t end)
+      {
+        for (auto pos = begin; pos < end;)
+        {
+          auto const last = atomEnd(pos);
+          auto const r = repeat(last);
+          repeated(pos, last, r);
+          pos = r.end;
+        }
+      }
+
+      constexpr void alternation(size_t begin, size_t end)
+      {
+        auto bar = begin;
+        while (bar < end && mRe[bar] != '|')
+        {
+          bar = repeat(atomEnd(bar)).end;
+        }
+        if (bar >= end)
+        {
+          sequence(begin, end);
+          return;
+        }
+        auto const split = emit(RegexOp::kSPLIT);
+        sequence(begin, bar);
+        auto const jump = emit(RegexOp::kJUMP);
+        setSplit(split, split + 1, mSize, false);
+        alternation(bar + 1, end);
+        setNext(jump, mSize);
+      }
+
+      std::string_view mRe;
+      std::array<RegexInst, capacity> mInsts{};
+      size_t mSize{};
+    };
+
+    template <size_t nbInsts>
+    class InstSet
+    {
+    public:
+      constexpr void add(size_t pc) { mWords[pc / 64] |= uint64_t{1} << (pc % 64); }
+      constexpr bool contains(size_t pc) const
+      {
+        return ((mWords[pc / 64] >> (pc % 64)) & 1U) != 0;
+      }
+      constexpr bool operator==(InstSet const &other) const
+      {
+        for (size_t i = 0; i < mWords.size(); ++i)
+        {
+          if (mWords[i] != other.mWords[i])
+          {
+            return false;
+          }
+        }
+        return true;
+      }
+
+    private:
+      std::array<uint64_t, (nbInsts + 63) / 64> mWords{};
+    };
+
+    // Bytes telling apart no instructions share a class.
+    class ByteClasses
+    {
+    public:
+      std::array<uint8_t, 256> classOf{};
+      std::array<uint8_t, 256> first{};
+      size_t size{};
+    };
+
+    template <size_t nbInsts>
+    constexpr ByteClasses byteClasses(std::array<RegexInst, nbInsts> const &insts)
+    {
+      // Splits the classes by the bytes of each instruction in turn.
+      ByteClasses classes;
+      classes.size = 1;
+      for (auto const &inst : insts)
+      {
+        if (inst.op != RegexOp::kBYTE)
+        {
+          continue;
+        }
+        std::array<size_t, 2 * 256> renamed{};
+        size_t size = 0;
+        for (size_t byte = 0; byte < 256; ++byte)
+        {
+          auto const inside = inst.bytes.contains(byte) ? 1U : 0U;
+          auto &name = renamed[size_t{classes.classOf[byte]} * 2 + inside];
+          if (name == 0)
+          {
+            name = ++size;
+          }
+          classes.classOf[byte] = static_cast<uint8_t>(name - 1);
+        }
+        classes.size = size;
+      }
+      for (size_t byte = 256; byte-- > 0;)
+      {
+        classes.first[classes.classOf[byte]] = static_cast<uint8_t>(byte);
+      }
+      return classes;
+    }
+
+    // The byte and match instructions reachable from seeds without consuming.
+    template <size_t nbInsts>
+    constexpr InstSet<nbInsts> regexClosure(std::array<RegexInst, nbInsts> const &insts,
+                                            InstSet<nbInsts> const &seeds)
+    {
+      InstSet<nbInsts> seen;
+      InstSet<nbInsts> result;
+      std::array<size_t, nbInsts> stack{};
+      size_t size = 0;
+      auto const push = [&](size_t pc)
+      {
+        if (!seen.contains(pc))
+        {
+          seen.add(pc);
+          stack[size++] = pc;
+        }
+      };
+      for (size_t pc = 0; pc < nbInsts; ++pc)
+      {
+        if (seeds.contains(pc))
+        {
+          push(pc);
+        }
+      }
+      while (size > 0)
+      {
+        auto const pc = stack[--size];
+        auto const &inst = insts[pc];
+        switch (inst.op)
+        {
+        case RegexOp::kSPLIT:
+          push(inst.next);
+          push(inst.other);
+          break;
+        case RegexOp::kJUMP:
+        case RegexOp::kSAVE:
+          push(inst.next);
+          break;
+        default:
+          result.add(pc);
+          break;
+        }
+      }
+      return result;
+    }
+
+    // State 0 fails, state 1 starts. size counts all states, even those beyond
+    // nbStates that are not kept.
+    template <size_t nbStates, size_t nbClasses>
+    class RegexDfa
+    {
+    public:
+      std::array<uint16_t, nbStates * nbClasses> next{};
+      std::array<bool, nbStates> accepts{};
+      size_t size{};
+    };
+
+    template <size_t nbStates, size_t nbClasses, size_t nbInsts>
+    constexpr auto regexDfa(std::array<RegexInst, nbInsts> const &insts,
+                            ByteClasses const &classes)
+    {
+      static_assert(nbStates <= 65536);
+      RegexDfa<nbStates, nbClasses> dfa;
+      if constexpr (nbStates < 2)
+      {
+        static_cast<void>(insts);
+        static_cast<void>(classes);
+        return dfa;
+      }
+      std::array<InstSet<nbInsts>, nbStates> sets{};
+      InstSet<nbInsts> start;
+      start.add(0);
+      sets[1] = regexClosure(insts, start);
+      dfa.size = 2;
+      for (size_t state = 1; state < dfa.size && dfa.size <= nbStates; ++state)
+      {
+        auto const &set = sets[state];
+        for (size_t pc = 0; pc < nbInsts; ++pc)
+        {
+          if (set.contains(pc) && insts[pc].op == RegexOp::kMATCH)
+          {
+            dfa.accepts[state] = true;
+          }
+        }
+        for (size_t c = 0; c < nbClasses; ++c)
+        {
+          InstSet<nbInsts> seeds;
+          for (size_t pc = 0; pc < nbInsts; ++pc)
+          {
+            if (set.contains(pc) && insts[pc].op == RegexOp::kBYTE &&
+                insts[pc].bytes.contains(classes.first[c]))
+            {
+              seeds.add(insts[pc].next);
+            }
+          }
+          auto const target = regexClosure(insts, seeds);
+          size_t found = 0;
+          while (found < dfa.size && !(sets[found] == target))
+          {
+            ++found;
+          }
+          if (found == dfa.size)
+          {
+            if (dfa.size == nbStates)
+            {
+              ++dfa.size;
+              break;
+            }
+            sets[dfa.size++] = target;
+          }
+          dfa.next[state * nbClasses + c] = static_cast<uint16_t>(found);
+        }
+      }
+      return dfa;
+    }
+
+    template <size_t nbStates, size_t capacity, size_t nbClasses>
+    constexpr auto shrinkDfa(RegexDfa<capacity, nbClasses> const &full)
+    {
+      RegexDfa<nbStates, nbClasses> dfa;
+      for (size_t i = 0; i < dfa.next.size(); ++i)
+      {
+        dfa.next[i] = full.next[i];
+      }
+      for (size_t i = 0; i < dfa.accepts.size(); ++i)
+      {
+        dfa.accepts[i] = full.accepts[i];
+      }
+      dfa.size = full.size;
+      return dfa;
+    }
+
+    // A regex compiled at compile time. Values are told apart with a DFA over
+    // classes of bytes, captures are found by a Pike VM.
+    template <typename Source>
+    class Regex
+    {
+      constexpr static auto nbInsts = RegexCompiler<0>{Source::value}.size();
+      constexpr static RegexCompiler<nbInsts> compiler{Source::value};
+      constexpr static auto const &insts = compiler.insts();
+      constexpr static auto classes = byteClasses(insts);
+      constexpr static auto nbClasses = classes.size;
+      constexpr static auto fullDfa =
+          regexDfa<MATCHIT_REGEX_DFA_STATES, nbClasses>(insts, classes);
+      constexpr static auto nbDfaStates = fullDfa.size;
+
+    public:
+      constexpr static auto hasDfa = nbDfaStates <= MATCHIT_REGEX_DFA_STATES;
+      constexpr static auto nbGroups = compiler.nbGroups();
+
+    private:
+      // Only the states used are kept in the program.
+      constexpr static auto dfa = shrinkDfa<hasDfa ? nbDfaStates : 0>(fullDfa);
+
+    private:
+      using Slots = std::array<size_t, 2 * nbGroups>;
+
+      class Thread
+      {
+      public:
+        size_t pc{};
+        Slots slots{};
+      };
+
+      class Threads
+      {
+      public:
+        std::array<Thread, nbInsts> threads{};
+        size_t size{};
+        // The step that last added each instruction.
+        std::array<size_t, nbInsts> steps{};
+      };
+
+      constexpr static void follow(Threads &threads, size_t step, size_t pc, Slots const &slots,
+                                   size_t pos)
+      {
+        if (threads.steps[pc] == step)
+        {
+          return;
+        }
+        threads.steps[pc] = step;
+        auto const &inst = insts[pc];
+        switch (inst.op)
+        {
+        case RegexOp::kSPLIT:
+          follow(threads, step, inst.next, slots, pos);
+          follow(threads, step, inst.other, slots, pos);
+          return;
+        case RegexOp::kJUMP:
+          follow(threads, step, inst.next, slots, pos);
+          return;
+        case RegexOp::kSAVE:
+        {
+          auto saved = slots;
+          saved[inst.other] = pos;
+          follow(threads, step, inst.next, saved, pos);
+          return;
+        }
+        default:
+          threads.threads[threads.size++] = Thread{pc, slots};
+          return;
+        }
+      }
+
+      // Runs the threads in priority order, so that the first one matching
+      // the whole subject has the captures of backtracking engines.
+      constexpr static bool simulate(std::string_view subject, Slots &slots)
+      {
+        std::array<Threads, 2> lists{};
+        Slots unset{};
+        for (auto &slot : unset)
+        {
+          slot = std::string_view::npos;
+        }
+        follow(lists[0], 1, 0, unset, 0);
+        for (size_t pos = 0;; ++pos)
+        {
+          auto const &current = lists[pos % 2];
+          auto &next = lists[(pos + 1) % 2];
+          next.size = 0;
+          for (size_t i = 0; i < current.size; ++i)
+          {
+            auto const &thread = current.threads[i];
+            auto const &inst = insts[thread.pc];
+            if (inst.op == RegexOp::kMATCH)
+            {
+              if (pos == subject.size())
+              {
+                slots = thread.slots;
+                return true;
+              }
+            }
+            else if (pos < subject.size() &&
+                     inst.bytes.contains(static_cast<unsigned char>(subject[pos])))
+            {
+              follow(next, pos + 2, inst.next, thread.slots, pos + 1);
+            }
+          }
+          if (pos == subject.size() || next.size == 0)
+          {
+            return false;
+          }
+        }
+      }
+
+    public:
+      constexpr static bool matches(std::string_view subject)
+      {
+        if constexpr (hasDfa)
+        {
+          size_t state = 1;
+          for (auto const c : subject)
+          {
+            state = dfa.next[state * nbClasses + classes.classOf[static_cast<unsigned char>(c)]];
+            if (state == 0)
+            {
+              return false;
+            }
+          }
+          return dfa.accepts[state];
+        }
+        else
+        {
+          Slots slots{};
+          return simulate(subject, slots);
+        }
+      }
+
+      // The captures of a subject that matches, empty for groups not taken.
+      constexpr static auto groups(std::string_view subject)
+      {
+        Slots slots{};
+        std::array<std::string_view, nbGroups> result{};
+        if (simulate(subject, slots))
+        {
+          for (size_t i = 0; i < nbGroups; ++i)
+          {
+            auto const begin = slots[2 * i];
+            auto const end = slots[2 * i + 1];
+            if (begin != std::string_view::npos && end != std::string_view::npos)
+            {
+              result[i] = subject.substr(begin, end - begin);
+            }
+          }
+        }
+        return result;
+      }
+    };
+
+    template <typename Source>
+    class RegexMatches
+    {
+    public:
+      constexpr bool operator()(std::string_view subject) const
+      {
+        return Regex<Source>::matches(subject);
+      }
+    };
+
+    template <typename Source>
+    class RegexGroups
+    {
+    public:
+      constexpr auto operator()(std::string_view subject) const
+      {
+        return Regex<Source>::groups(subject);
+      }
+    };
+
+    template <typename Source, typename... Patterns>
+    constexpr auto regexPattern(Patterns const &...patterns)
+    {
+      if constexpr (sizeof...(Patterns) == 0)
+      {
+        return meet(RegexMatches<Source>{});
+      }
+      else
+      {
+        static_assert(sizeof...(Patterns) == Regex<Source>::nbGroups ||
+                          nbOooOrBinderV<Patterns...> > 0,
+                      "regex takes a pattern for each capturing group.");
+        return and_(meet(RegexMatches<Source>{}), app(RegexGroups<Source>{}, ds(patterns...)));
+      }
+    }
+
+#if defined(__cpp_nontype_template_args) && __cpp_nontype_template_args >= 201911L
+    template <size_t size>
+    class RegexString
+    {
+    public:
+      constexpr RegexString(char const (&re)[size])
+      {
+        for (size_t i = 0; i < size; ++i)
+        {
+          chars[i] = re[i];
+        }
+      }
+
+      char chars[size]{};
+    };
+
+    template <RegexString re>
+    class RegexSource
+    {
+    public:
+      constexpr static std::string_view value{re.chars, sizeof(re.chars) - 1};
+    };
+
+    // Matches the regex re against whole values converted to std::string_view,
+    // and its capturing groups against patterns, such as Id<std::string_view>.
+    template <RegexString re, typename... Patterns>
+    constexpr auto regex(Patterns const &...patterns)
+    {
+      return regexPattern<RegexSource<re>>(patterns...);
+    }
+#else
+    template <char const *re>
+    class RegexSource
+    {
+    public:
+      constexpr static std::string_view value{re};
+    };
+
+    // Matches the regex re against whole values converted to std::string_view,
+    // and its capturing groups against patterns, such as Id<std::string_view>.
+    template <char const *re, typename... Patterns>
+    constexpr auto regex(Patterns const &...patterns)
+    {
+      return regexPattern<RegexSource<re>>(patterns...);
+    }
+#endif
+
+  } // namespace impl
+  using impl::regex;
+} // namespace matchit
+
+#endif // MATCHIT_REGEX_H
@@ -2,6 +2,10 @@
 #define MATCHIT_UTILITY_H
 
 #include <any>
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <typeinfo>
 #include <variant>
 
 namespace matchit
@@ -21,6 +25,23 @@ namespace matchit
 
     constexpr auto none = app(cast<bool>, false);
 
+    template <>
+    class PureUnary<std::decay_t<decltype(cast<bool>)>> : public std::true_type
+    {
+    };
+
+    template <>
+    class PureUnary<std::decay_t<decltype(deref)>> : public std::true_type
+    {
+    };
+
+    template <typename Pattern>
+    class SomeOf<And<App<decltype(cast<bool>) &, bool>, App<decltype(deref) &, Pattern>>>
+    {
+    public:
+      using type = Pattern;
+    };
+
     template <typename Value, typename Variant, typename = std::void_t<>>
     struct ViaGetIf : std::false_type
     {
@@ -41,6 +62,144 @@ namespace matchit
 
     static_assert(viaGetIfV<int, std::variant<int, bool>>);
 
+    // Classes declaring their own classof, specialized by users as
+    // std::true_type. A classof inherited from a base class tells whether
+    // an object is of that base rather than of T, so it is not enough.
+    template <typename T>
+    class DeclaresClassOf : public std::false_type
+    {
+    };
+
+    // LLVM style closed hierarchies: T::classof(base) tells whether the
+    // object of type B pointed to by base is a T.
+    template <typename T, typename B, typename = std::void_t<>>
+    struct ViaClassOf : std::false_type
+    {
+    };
+
+    template <typename T, typename B>
+    struct ViaClassOf<T, B, std::void_t<decltype(T::classof(std::declval<B const *>()))>>
+        : DeclaresClassOf<T>
+    {
+    };
+
+    template <typename T, typename B>
+    constexpr auto viaClassOfV = ViaClassOf<T, B>::value;
+
+    template <typename T, typename B>
+    class ViaDowncast
+        : public std::bool_constant<std::is_polymorphic_v<B> && std::is_base_of_v<B, T> &&
+                                    !std::is_same_v<B, T> && !viaGetIfV<T, B> &&
+                                    !viaClassOfV<T, B>>
+    {
+    };
+
+    template <typename T, typename B, typename = std::void_t<>>
+    struct StaticDowncast : std::false_type
+    {
+    };
+
+    template <typename T, typename B>
+    struct StaticDowncast<T, B,
+                          std::void_t<decltype(static_cast<T const *>(std::declval<B const *>()))>>
+        : std::true_type
+    {
+    };
+
+    // dynamic_cast from B to T, remembering per thread its outcome for the
+    // most derived types met lately. The outcome only depends on the most
+    // derived type and on where the B is in it, so that downcasts known to
+    // fail or to be plain static_casts skip the walk over the hierarchy.
+    template <typename T, typename B>
+    class Downcast
+    {
+      enum class Outcome : uint8_t
+      {
+        kNULL,
+        kSTATIC,
+        kDYNAMIC
+      };
+
+      class Entry
+      {
+      public:
+        std::type_info const *type;
+        std::ptrdiff_t top;
+        Outcome outcome;
+      };
+
+      constexpr static size_t kNB_ENTRIES = 16;
+
+      static Outcome outcome(B const *b, T const *t)
+      {
+        if (t == nullptr)
+        {
+          return Outcome::kNULL;
+        }
+        if constexpr (StaticDowncast<T, B>::value)
+        {
+          if (static_cast<B const *>(t) == b)
+          {
+            return Outcome::kSTATIC;
+          }
+        }
+        return Outcome::kDYNAMIC;
+      }
+
+      static Entry &slot(std::type_info const *type, std::ptrdiff_t top)
+      {
+        thread_local std::array<Entry, kNB_ENTRIES> sEntries{};
+        return sEntries[((reinterpret_cast<uintptr_t>(type) >> 4) ^
+                         static_cast<uintptr_t>(top)) %
+                        kNB_ENTRIES];
+      }
+
+      // Kept apart from cast so that the cached path stays small enough to
+      // be inlined into every arm.
+      static T const *miss(B const *b, std::type_info const *type, std::ptrdiff_t top)
+      {
+        auto const *const t = dynamic_cast<T const *>(b);
+        auto &entry = slot(type, top);
+        if (entry.type != type || entry.top != top)
+        {
+          entry = Entry{type, top, outcome(b, t)};
+        }
+        return t;
+      }
+
+    public:
+      static T const *cast(B const *b)
+      {
+        // Final classes are their most derived types.
+        if constexpr (std::is_final_v<T> && StaticDowncast<T, B>::value)
+        {
+          return typeid(*b) == typeid(T) ? static_cast<T const *>(b) : nullptr;
+        }
+        else
+        {
+          auto const *const type = &typeid(*b);
+          auto const top = reinterpret_cast<char const *>(b) -
+                           static_cast<char const *>(dynamic_cast<void const *>(b));
+          auto const &entry = slot(type, top);
+          if (entry.type == type && entry.top == top)
+          {
+            if (entry.outcome == Outcome::kNULL)
+            {
+              return nullptr;
+            }
+            if constexpr (StaticDowncast<T, B>::value)
+            {
+              if (entry.outcome == Outcome::kSTATIC)
+              {
+                return static_cast<T const *>(b);
+              }
+            }
+          }
+          return miss(b, type, top);
+        }
+      }
+    };
+
     template <typename T>
     class AsPointer
     {
@@ -78,19 +237,35 @@ namespace matchit
       }
 
       // cast to derived class
-      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
+      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && !viaClassOfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
       constexpr auto operator()(B const& b) const
           -> decltype(dynamic_cast<T const *>(std::addressof(b)))
       {
-        return dynamic_cast<T const *>(std::addressof(b));
+        return Downcast<T, B>::cast(std::addressof(b));
       }
 
       // cast to derived class
-      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
+      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && !viaClassOfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
       constexpr auto operator()(B& b) const
           -> decltype(dynamic_cast<T*>(std::addressof(b)))
       {
-        return dynamic_cast<T*>(std::addressof(b));
+        return const_cast<T *>(Downcast<T, B>::cast(std::addressof(b)));
+      }
+
+      // cast to derived class of closed hierarchies
+      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && viaClassOfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
+      constexpr auto operator()(B const& b) const
+          -> decltype(static_cast<T const *>(std::addressof(b)))
+      {
+        return T::classof(std::addressof(b)) ? static_cast<T const *>(std::addressof(b)) : nullptr;
+      }
+
+      // cast to derived class of closed hierarchies
+      template <typename B, typename std::enable_if<!viaGetIfV<T, B> && viaClassOfV<T, B> && std::is_base_of_v<B, T>>::type * = nullptr>
+      constexpr auto operator()(B& b) const
+          -> decltype(static_cast<T*>(std::addressof(b)))
+      {
+        return T::classof(std::addressof(b)) ? static_cast<T *>(std::addressof(b)) : nullptr;
       }
 
       constexpr auto operator()(T const& b) const
@@ -104,6 +279,11 @@ namespace matchit
       }
     };
 
+    template <typename T>
+    class PureUnary<AsPointer<T>> : public std::true_type
+    {
+    };
+
     static_assert(std::is_invocable_v<AsPointer<int>, int>);
     static_assert(std::is_invocable_v<AsPointer<std::tuple<int>>, std::tuple<int>>);
 
@@ -141,11 +321,104 @@ namespace matchit
       };
     };
 
+    // Instrumentation policy keeping relaxed atomic counters per arm of the
+    // match sites using it. Sites are told apart by the tag type Site.
+    template <typename Site, size_t maxArms = 32, size_t maxDepth = 8>
+    class ArmCounters : public NoInstrumentation
+    {
+    public:
+      class Arm
+      {
+      public:
+        std::atomic<uint64_t> attempts;
+        std::atomic<uint64_t> hits;
+        // Misses by the deepest level at which a sub-pattern mismatched,
+        // deeper levels counted in the last one.
+        std::array<std::atomic<uint64_t>, maxDepth> misses;
+      };
+
+      static void enter(size_t nbArms)
+      {
+        sMatches.fetch_add(1, std::memory_order_relaxed);
+        sNbArms.store(std::min(nbArms, maxArms), std::memory_order_relaxed);
+      }
+      static void attempt(size_t arm)
+      {
+        if (arm < maxArms)
+        {
+          sArms[arm].attempts.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      static void hit(size_t arm)
+      {
+        if (arm < maxArms)
+        {
+          sArms[arm].hits.fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      static void miss(size_t arm, int32_t depth)
+      {
+        if (arm < maxArms)
+        {
+          auto const level = std::min(static_cast<size_t>(std::max(depth, 0)), maxDepth - 1);
+          sArms[arm].misses[level].fetch_add(1, std::memory_order_relaxed);
+        }
+      }
+      static void noMatch() { sNoMatches.fetch_add(1, std::memory_order_relaxed); }
+
+      static uint64_t matches() { return sMatches.load(std::memory_order_relaxed); }
+      static uint64_t noMatches() { return sNoMatches.load(std::memory_order_relaxed); }
+      static size_t nbArms() { return sNbArms.load(std::memory_order_relaxed); }
+      static Arm const &arm(size_t i) { return sArms[i]; }
+
+      static void reset()
+      {
+        sMatches.store(0, std::memory_order_relaxed);
+        sNoMatches.store(0, std::memory_order_relaxed);
+        for (auto &a : sArms)
+        {
+          a.attempts.store(0, std::memory_order_relaxed);
+          a.hits.store(0, std::memory_order_relaxed);
+          for (auto &m : a.misses)
+          {
+            m.store(0, std::memory_order_relaxed);
+          }
+        }
+      }
+
+      // Writes one line per arm to an output stream, arms never hit being
+      // candidates for removal.
+      template <typename Stream>
+      static void report(Stream &os)
+      {
+        os << "matches: " << matches() << ", no match: " << noMatches() << '\n';
+        for (size_t i = 0; i < nbArms(); ++i)
+        {
+          auto const &a = arm(i);
+          os << "arm " << i << ": attempts " << a.attempts.load(std::memory_order_relaxed)
+             << ", hits " << a.hits.load(std::memory_order_relaxed) << ", misses by depth";
+          for (auto const &m : a.misses)
+          {
+            os << ' ' << m.load(std::memory_order_relaxed);
+          }
+          os << '\n';
+        }
+      }
+
+    private:
+      inline static std::atomic<uint64_t> sMatches{};
+      inline static std::atomic<uint64_t> sNoMatches{};
+      inline static std::atomic<size_t> sNbArms{};
+      inline static std::array<Arm, maxArms> sArms{};
+    };
+
   } // namespace impl
+  using impl::ArmCounters;
   using impl::as;
   using impl::asDsVia;
   using impl::dsVia;
   using impl::matched;
+  using impl::NoInstrumentation;
   using impl::none;
   using impl::some;
 } // namespace matchit
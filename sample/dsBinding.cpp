@@ -0,0 +1,53 @@
+#include "matchit.h"
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <tuple>
+#include <vector>
+
+// Binding elements with ds(i, j) compared with structured bindings.
+
+int64_t viaMatch(std::tuple<int32_t, int32_t> const &p)
+{
+  using namespace matchit;
+  Id<int32_t> i;
+  Id<int32_t> j;
+  return match(p)(
+      // clang-format off
+      pattern | ds(i, j) = [&] { return int64_t{*i} * *j; }
+      // clang-format on
+  );
+}
+
+int64_t viaBinding(std::tuple<int32_t, int32_t> const &p)
+{
+  auto const &[i, j] = p;
+  return int64_t{i} * j;
+}
+
+template <typename Func>
+auto measure(std::vector<std::tuple<int32_t, int32_t>> const &pairs, Func func)
+{
+  auto const start = std::chrono::steady_clock::now();
+  int64_t sum = 0;
+  for (auto const &p : pairs)
+  {
+    sum += func(p);
+  }
+  auto const end = std::chrono::steady_clock::now();
+  return std::make_tuple(sum, std::chrono::duration<double, std::milli>(end - start).count());
+}
+
+int32_t main()
+{
+  std::vector<std::tuple<int32_t, int32_t>> pairs;
+  for (int32_t k = 0; k < 1000000; ++k)
+  {
+    pairs.emplace_back(k % 1000, k / 1000);
+  }
+  auto const [sumMatch, msMatch] = measure(pairs, viaMatch);
+  auto const [sumBinding, msBinding] = measure(pairs, viaBinding);
+  std::cout << "ds(i, j): " << msMatch << " ms, structured bindings: " << msBinding << " ms"
+            << std::endl;
+  return sumMatch == sumBinding ? 0 : 1;
+}
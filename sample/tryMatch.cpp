@@ -0,0 +1,34 @@
+#include "matchit.h"
+#include <iostream>
+#include <optional>
+
+// Built with -fno-exceptions.
+enum class Op
+{
+  Add,
+  Sub,
+  Mul,
+  Div
+};
+
+constexpr std::optional<Op> parseOp(char t)
+{
+  using namespace matchit;
+  return tryMatch(t)(
+      // clang-format off
+      pattern | '+' = Op::Add,
+      pattern | '-' = Op::Sub,
+      pattern | '*' = Op::Mul,
+      pattern | '/' = Op::Div
+      // clang-format on
+  );
+}
+
+static_assert(parseOp('*') == Op::Mul);
+static_assert(!parseOp('%').has_value());
+
+int32_t main()
+{
+  std::cout << static_cast<int>(parseOp('/').value_or(Op::Add)) << std::endl;
+  return 0;
+}
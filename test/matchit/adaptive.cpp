@@ -0,0 +1,156 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace matchit;
+
+TEST(AdaptiveMatcher, values)
+{
+  auto const m = adaptiveMatcher(
+      // clang-format off
+      pattern | 1 = 10,
+      pattern | 2 = 20,
+      pattern | 3 = 30,
+      pattern | _ = 0
+      // clang-format on
+  );
+  EXPECT_TRUE(m.adaptive());
+  for (int32_t i = 0; i < 5000; ++i)
+  {
+    EXPECT_EQ(m(3), 30);
+  }
+  EXPECT_EQ(m(1), 10);
+  EXPECT_EQ(m(2), 20);
+  EXPECT_EQ(m(3), 30);
+  EXPECT_EQ(m(4), 0);
+}
+
+TEST(AdaptiveMatcher, overlappingArmsKeepOrder)
+{
+  auto const m = adaptiveMatcher(
+      // clang-format off
+      pattern | 1 = 10,
+      pattern | 1 = 20,
+      pattern | 2 = 30
+      // clang-format on
+  );
+  EXPECT_FALSE(m.adaptive());
+  for (int32_t i = 0; i < 5000; ++i)
+  {
+    EXPECT_EQ(m(1), 10);
+  }
+  EXPECT_EQ(m.tryMatch(3), std::nullopt);
+}
+
+TEST(AdaptiveMatcher, disjoint)
+{
+  EXPECT_TRUE(impl::disjoint(1, 2));
+  EXPECT_FALSE(impl::disjoint(1, 1));
+  EXPECT_FALSE(impl::disjoint(1, 1.0));
+  EXPECT_TRUE(impl::disjoint(lit<1>, 2));
+  EXPECT_FALSE(impl::disjoint(lit<2>, 2));
+  EXPECT_TRUE(impl::disjoint(_ < 0, 0 <= _));
+  EXPECT_FALSE(impl::disjoint(_ <= 0, 0 <= _));
+  EXPECT_TRUE(impl::disjoint(_ < 0, 5));
+  EXPECT_FALSE(impl::disjoint(5, _ > 0));
+  EXPECT_TRUE(impl::disjoint(impl::StringLiteral<2>{"ab"}, impl::StringLiteral<2>{"ac"}));
+  EXPECT_TRUE(impl::disjoint(impl::StringLiteral<2>{"ab"}, impl::StringLiteral<1>{"a"}));
+  EXPECT_FALSE(impl::disjoint(impl::StringLiteral<1>{"a"}, impl::StringLiteral<1>{"a"}));
+}
+
+// Counts the comparisons made while probing arms.
+struct Probe
+{
+  int32_t value;
+};
+
+static int32_t nbProbes = 0;
+
+bool operator==(int32_t l, Probe const &r)
+{
+  ++nbProbes;
+  return l == r.value;
+}
+
+TEST(AdaptiveMatcher, hotArmFirst)
+{
+  auto const m = adaptiveMatcher(
+      // clang-format off
+      pattern | 1 = 1,
+      pattern | 2 = 2,
+      pattern | 3 = 3,
+      pattern | 4 = 4,
+      pattern | 5 = 5,
+      pattern | _ = 0
+      // clang-format on
+  );
+  for (int32_t i = 0; i < 2048; ++i)
+  {
+    EXPECT_EQ(m(Probe{5}), 5);
+  }
+  nbProbes = 0;
+  EXPECT_EQ(m(Probe{5}), 5);
+  EXPECT_EQ(nbProbes, 1);
+
+  // Follows a shift to another arm.
+  for (int32_t i = 0; i < 8192; ++i)
+  {
+    EXPECT_EQ(m(Probe{2}), 2);
+  }
+  nbProbes = 0;
+  EXPECT_EQ(m(Probe{2}), 2);
+  EXPECT_EQ(nbProbes, 1);
+
+  nbProbes = 0;
+  EXPECT_EQ(m(Probe{7}), 0);
+  EXPECT_EQ(nbProbes, 5);
+}
+
+TEST(AdaptiveMatcher, restArms)
+{
+  Id<std::string> s;
+  auto const m = adaptiveMatcher(
+      // clang-format off
+      pattern | "ab"            = std::string("first"),
+      pattern | "cd"            = std::string("second"),
+      pattern | s.at(_ != "ef") = s + "!"
+      // clang-format on
+  );
+  EXPECT_TRUE(m.adaptive());
+  EXPECT_EQ(m(std::string("cd")), "second");
+  EXPECT_EQ(m(std::string("gh")), "gh!");
+  EXPECT_EQ(m.tryMatch(std::string("ef")), std::nullopt);
+  EXPECT_EQ(*m.tryMatch(std::string("ab")), "first");
+}
+
+TEST(AdaptiveMatcher, threads)
+{
+  auto const m = adaptiveMatcher(
+      // clang-format off
+      pattern | 1 = 1,
+      pattern | 2 = 2,
+      pattern | 3 = 3,
+      pattern | _ = 0
+      // clang-format on
+  );
+  std::vector<std::thread> threads;
+  std::vector<int32_t> wrong(4);
+  for (int32_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+        [&, t]
+        {
+          for (int32_t i = 0; i < 5000; ++i)
+          {
+            auto const v = (i + t) % 5;
+            wrong[static_cast<size_t>(t)] += m(v) != (v <= 3 ? v : 0);
+          }
+        });
+  }
+  for (auto &t : threads)
+  {
+    t.join();
+  }
+  EXPECT_EQ(wrong, std::vector<int32_t>(4));
+}
@@ -0,0 +1,103 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <any>
+#include <string>
+#include <thread>
+#include <vector>
+using namespace matchit;
+
+static_assert(impl::AnyDispatch<
+              std::any, std::tuple<decltype(as<int32_t>(_)), decltype(as<char>(_))>>::enabled);
+static_assert(!impl::AnyDispatch<std::any, std::tuple<decltype(as<int32_t>(_))>>::enabled);
+static_assert(!impl::AnyDispatch<int32_t, std::tuple<decltype(as<int32_t>(_)),
+                                                     decltype(as<char>(_))>>::enabled);
+
+auto describe(std::any const &a)
+{
+  Id<int32_t> i;
+  Id<std::string> s;
+  return match(a)(
+      // clang-format off
+      pattern | as<int32_t>(0)                 = std::string{"zero"},
+      pattern | as<std::string>(s)             = [&] { return "string " + *s; },
+      pattern | as<int32_t>(i) | when(i > 0)   = std::string{"positive"},
+      pattern | as<int32_t>(_)                 = std::string{"negative"},
+      pattern | as<char>('c')                  = std::string{"c"},
+      pattern | _                              = std::string{"other"}
+      // clang-format on
+  );
+}
+
+TEST(Any, dispatchByType)
+{
+  EXPECT_EQ(describe(0), "zero");
+  EXPECT_EQ(describe(3), "positive");
+  EXPECT_EQ(describe(-3), "negative");
+  EXPECT_EQ(describe(std::string{"abc"}), "string abc");
+  EXPECT_EQ(describe('c'), "c");
+  EXPECT_EQ(describe('d'), "other");
+  EXPECT_EQ(describe(1.0), "other");
+  EXPECT_EQ(describe(std::any{}), "other");
+}
+
+TEST(Any, statement)
+{
+  int32_t sum = 0;
+  for (std::any const &a : {std::any{1}, std::any{'a'}, std::any{2.5}, std::any{2}})
+  {
+    match(a)(
+        // clang-format off
+        pattern | as<char>(_)    = [&] { sum += 10; },
+        pattern | as<int32_t>(_) = [&] { sum += 1; }
+        // clang-format on
+    );
+  }
+  EXPECT_EQ(sum, 12);
+}
+
+template <int32_t I>
+struct Event
+{
+};
+
+int32_t code(std::any const &a)
+{
+  return match(a)(
+      // clang-format off
+      pattern | as<Event<0>>(_) = 0,
+      pattern | as<Event<1>>(_) = 1,
+      pattern | as<Event<2>>(_) = 2,
+      pattern | as<Event<3>>(_) = 3,
+      pattern | _               = -1
+      // clang-format on
+  );
+}
+
+TEST(Any, threads)
+{
+  std::vector<std::any> const events = {Event<3>{}, Event<0>{}, 0, Event<2>{}, Event<1>{}};
+  std::vector<std::thread> threads;
+  std::vector<int32_t> sums(4);
+  for (auto &sum : sums)
+  {
+    threads.emplace_back(
+        [&]
+        {
+          for (size_t i = 0; i < 1000; ++i)
+          {
+            for (auto const &e : events)
+            {
+              sum += code(e);
+            }
+          }
+        });
+  }
+  for (auto &t : threads)
+  {
+    t.join();
+  }
+  for (auto const sum : sums)
+  {
+    EXPECT_EQ(sum, 5000);
+  }
+}
@@ -0,0 +1,48 @@
+#define MATCHIT_ANY_TYPE_POINTERS 1
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <any>
+#include <string>
+using namespace matchit;
+
+static_assert(MATCHIT_ANY_TYPE_POINTERS);
+
+static std::string describe(std::any const &a)
+{
+  Id<int32_t> i;
+  Id<std::string> s;
+  return match(a)(
+      // clang-format off
+      pattern | as<int32_t>(0)                 = std::string{"zero"},
+      pattern | as<std::string>(s)             = [&] { return "string " + *s; },
+      pattern | as<int32_t>(i) | when(i > 0)   = std::string{"positive"},
+      pattern | as<int32_t>(_)                 = std::string{"negative"},
+      pattern | _                              = std::string{"other"}
+      // clang-format on
+  );
+}
+
+TEST(AnyTypePointers, dispatchByType)
+{
+  EXPECT_EQ(describe(0), "zero");
+  EXPECT_EQ(describe(3), "positive");
+  EXPECT_EQ(describe(-3), "negative");
+  EXPECT_EQ(describe(std::string{"abc"}), "string abc");
+  EXPECT_EQ(describe('c'), "other");
+  EXPECT_EQ(describe(std::any{}), "other");
+}
+
+TEST(AnyTypePointers, statement)
+{
+  int32_t sum = 0;
+  for (std::any const &a : {std::any{1}, std::any{'a'}, std::any{2.5}, std::any{2}})
+  {
+    match(a)(
+        // clang-format off
+        pattern | as<char>(_)    = [&] { sum += 10; },
+        pattern | as<int32_t>(_) = [&] { sum += 1; }
+        // clang-format on
+    );
+  }
+  EXPECT_EQ(sum, 12);
+}
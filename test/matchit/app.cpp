@@ -1,5 +1,8 @@
 #include "matchit.h"
 #include <gtest/gtest.h>
+#include <cctype>
+#include <memory>
+#include <string>
 using namespace matchit;
 
 class Base
@@ -42,3 +45,159 @@ TEST(App, scalarMut)
   );
   EXPECT_EQ(*x, 20);
 }
+
+int32_t nbHalves = 0;
+constexpr auto half = [](int32_t x)
+{
+  ++nbHalves;
+  return x / 2;
+};
+
+// half only counts its calls, it is pure as far as matching is concerned.
+namespace matchit::impl
+{
+  template <>
+  class PureUnary<std::decay_t<decltype(half)>> : public std::true_type
+  {
+  };
+} // namespace matchit::impl
+
+TEST(App, sharedProjection)
+{
+  nbHalves = 0;
+  auto const result = match(4)(
+      // clang-format off
+      pattern | app(half, 1)      = 1,
+      pattern | app(half, _ > 5)  = 2,
+      pattern | app(half, 2)      = 3,
+      pattern | _                 = 4
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+  EXPECT_EQ(nbHalves, 1);
+}
+
+int32_t nbThirds = 0;
+constexpr auto third = [](int32_t x)
+{
+  ++nbThirds;
+  return x / 3;
+};
+
+TEST(App, impureProjection)
+{
+  nbThirds = 0;
+  auto const result = match(6)(
+      // clang-format off
+      pattern | app(third, 1)      = 1,
+      pattern | app(third, _ > 5)  = 2,
+      pattern | app(third, 2)      = 3,
+      pattern | _                  = 4
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+  EXPECT_EQ(nbThirds, 3);
+}
+
+TEST(App, sharedProjectionOnDifferentInputs)
+{
+  constexpr auto first = [](auto &&t) -> decltype(auto) { return std::get<0>(t); };
+  constexpr auto second = [](auto &&t) -> decltype(auto) { return std::get<1>(t); };
+  nbHalves = 0;
+  Id<int32_t> x;
+  auto const result = match(std::make_tuple(2, 4))(
+      // clang-format off
+      pattern | app(first, app(half, 2))          = 1,
+      pattern | app(second, app(half, and_(2, x))) = [&] { return *x; },
+      pattern | _                                  = 0
+      // clang-format on
+  );
+  EXPECT_EQ(result, 2);
+  EXPECT_EQ(nbHalves, 2);
+}
+
+// Temporaries of different arms reuse the same slots, their projections are
+// not shared.
+TEST(App, projectionOfTemporaries)
+{
+  constexpr auto mk1 = [](int32_t) { return std::make_unique<int32_t>(1); };
+  constexpr auto mk2 = [](int32_t) { return std::make_unique<int32_t>(101); };
+  auto const result = match(1)(
+      // clang-format off
+      pattern | app(mk1, some(0))   = 1,
+      pattern | app(mk2, some(101)) = 2,
+      pattern | _                   = 3
+      // clang-format on
+  );
+  EXPECT_EQ(result, 2);
+}
+
+TEST(App, sharedAs)
+{
+  std::variant<int32_t, std::string> const v = std::string{"abc"};
+  Id<std::string> s;
+  auto const result = match(v)(
+      // clang-format off
+      pattern | as<int32_t>(_)     = 0,
+      pattern | as<std::string>("") = 1,
+      pattern | as<std::string>(s)  = [&] { return static_cast<int32_t>((*s).size()); }
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+}
+
+template <typename Value, typename... PatternPairs>
+constexpr auto contextOf(PatternPairs const &...)
+{
+  return typename impl::ContextTrait<Value, PatternPairs...>::ContextT{};
+}
+
+// Arms share the slots of the arm needing the most temporaries.
+constexpr auto kPlusOne = [](int32_t i) { return i + 1; };
+static_assert(sizeof(contextOf<int32_t>(
+                  // clang-format off
+                  pattern | app(kPlusOne, 1)                 = 1,
+                  pattern | app(kPlusOne, app(kPlusOne, 2))  = 2,
+                  pattern | app(kPlusOne, 3)                 = 3,
+                  pattern | _                                = 4
+                  // clang-format on
+                  )) == sizeof(std::array<int32_t, 2>) + sizeof(size_t));
+static_assert(std::is_empty_v<decltype(contextOf<int32_t>(pattern | 1 = 1, pattern | _ = 2))>);
+
+constexpr int32_t plusOneTwice(int32_t i)
+{
+  return match(i)(
+      // clang-format off
+      pattern | app(kPlusOne, 1)                = 1,
+      pattern | app(kPlusOne, app(kPlusOne, 3)) = 2,
+      pattern | app(kPlusOne, 5)                = 3,
+      pattern | _                               = 4
+      // clang-format on
+  );
+}
+static_assert(plusOneTwice(1) == 2 && plusOneTwice(4) == 3 && plusOneTwice(0) == 1);
+
+TEST(App, temporariesAcrossArms)
+{
+  constexpr auto upper = [](std::string const &s)
+  {
+    auto result = s;
+    for (auto &c : result)
+    {
+      c = static_cast<char>(std::toupper(c));
+    }
+    return result;
+  };
+  Id<std::string> s;
+  auto const m = matcher(
+      // clang-format off
+      pattern | app(upper, "A")                     = std::string{"a"},
+      pattern | app(upper, "B")                     = std::string{"b"},
+      pattern | app(upper, s.at(std::string{"CD"})) = [&] { return *s; },
+      pattern | _                                   = std::string{}
+      // clang-format on
+  );
+  EXPECT_EQ(m(std::string{"b"}), "b");
+  EXPECT_EQ(m(std::string{"cd"}), "CD");
+  EXPECT_EQ(m(std::string{"e"}), "");
+}
@@ -0,0 +1,74 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <vector>
+using namespace matchit;
+
+TEST(Batch, clip)
+{
+  std::vector<double> const in{-2, -0.5, 0, 3, 7, 12};
+  std::vector<double> out(in.size());
+  matchBatch(in, out,
+             // clang-format off
+             pattern | (_ < 0.0)  = 0.0,
+             pattern | (_ > 10.0) = 10.0,
+             pattern | _          = 5.0
+             // clang-format on
+  );
+  EXPECT_EQ(out, (std::vector<double>{0, 0, 5, 5, 5, 10}));
+}
+
+TEST(Batch, literals)
+{
+  std::array<int32_t, 6> const in{1, 5, 7, 2, 'q', -3};
+  std::array<int32_t, 6> out{};
+  matchBatch(in, out,
+             // clang-format off
+             pattern | or_(1, 2)              = 1,
+             pattern | lit<7>                 = 2,
+             pattern | ('a' <= _ && _ <= 'z') = 3,
+             pattern | _                      = 0
+             // clang-format on
+  );
+  EXPECT_EQ(out, (std::array<int32_t, 6>{1, 0, 2, 1, 3, 0}));
+}
+
+TEST(Batch, noMatch)
+{
+  std::array<int32_t, 3> const in{1, 2, 3};
+  std::array<int32_t, 3> out{};
+  EXPECT_THROW(matchBatch(in, out, pattern | lit<1> = 1, pattern | lit<2> = 2),
+               std::logic_error);
+}
+
+TEST(Batch, index)
+{
+  std::array<int32_t, 6> const in{1, 5, 7, 2, 100, -3};
+  std::array<uint8_t, 6> out{};
+  matchBatchIndex(in, out,
+                  // clang-format off
+                  pattern | or_(1, 2)  = 0,
+                  pattern | lit<7>     = 0,
+                  pattern | (_ > 50)   = 0
+                  // clang-format on
+  );
+  EXPECT_EQ(out, (std::array<uint8_t, 6>{0, 3, 1, 0, 2, 3}));
+}
+
+TEST(Batch, bindings)
+{
+  std::array<int32_t, 4> const in{1, 5, 7, -3};
+  std::array<int32_t, 4> out{};
+  Id<int32_t> i;
+  matchBatch(in, out,
+             // clang-format off
+             pattern | i.at(_ > 4) = i,
+             pattern | _           = -1
+             // clang-format on
+  );
+  EXPECT_EQ(out, (std::array<int32_t, 4>{-1, 5, 7, -1}));
+
+  std::array<size_t, 4> indices{};
+  matchBatchIndex(in, indices, pattern | i.at(_ > 4) = i, pattern | 1 = 0);
+  EXPECT_EQ(indices, (std::array<size_t, 4>{1, 0, 0, 2}));
+}
@@ -0,0 +1,91 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <tuple>
+#include <variant>
+#include <vector>
+using namespace matchit;
+
+constexpr int32_t sumOrScale(std::tuple<int32_t, int32_t> const &t)
+{
+  return match(t)(
+      // clang-format off
+      pattern | ds(1, capture<int32_t>)                = [](int32_t b) { return b * 10; },
+      pattern | ds(capture<int32_t>, capture<int32_t>) = [](int32_t a, int32_t b) { return a + b; }
+      // clang-format on
+  );
+}
+
+static_assert(sumOrScale({1, 5}) == 50);
+static_assert(sumOrScale({2, 5}) == 7);
+
+static_assert(std::is_same_v<impl::CaptureTupleT<decltype(ds(
+                                 capture<int32_t>, _,
+                                 and_(capture<char>, capture<char const &>)))>,
+                             std::tuple<int32_t, char, char const &>>);
+
+TEST(Capture, reference)
+{
+  std::tuple<std::string, int32_t> const t{"ab", 3};
+  auto const same = match(t)(
+      // clang-format off
+      pattern | ds(capture<std::string const &>, 3) = [&](std::string const &s) { return &s == &std::get<0>(t); },
+      pattern | _                                   = false
+      // clang-format on
+  );
+  EXPECT_TRUE(same);
+}
+
+TEST(Capture, moved)
+{
+  std::variant<int32_t, std::unique_ptr<int32_t>> v = std::make_unique<int32_t>(5);
+  auto const result = match(std::move(v))(
+      // clang-format off
+      pattern | as<int32_t>(_) = [] { return std::unique_ptr<int32_t>{}; },
+      pattern | as<std::unique_ptr<int32_t>>(capture<std::unique_ptr<int32_t> &>) =
+          [](std::unique_ptr<int32_t> &p) { return std::move(p); }
+      // clang-format on
+  );
+  ASSERT_TRUE(result);
+  EXPECT_EQ(*result, 5);
+}
+
+TEST(Capture, copiedAcrossArms)
+{
+  auto const never = false;
+  auto const m = matcher(
+      // clang-format off
+      pattern | app(&std::string::size, capture<size_t>) | when(expr(never))     = [](size_t) { return 1; },
+      pattern | and_(capture<std::string>, app(&std::string::size, size_t{2})) = [](std::string s) { return static_cast<int32_t>(s[0]); },
+      pattern | _                                                              = 0
+      // clang-format on
+  );
+  EXPECT_EQ(m(std::string{"ab"}), 'a');
+  EXPECT_EQ(m(std::string{"abc"}), 0);
+}
+
+TEST(Capture, ooo)
+{
+  auto const ends = [](std::vector<int32_t> const &v)
+  {
+    return match(v)(
+        // clang-format off
+        pattern | ds(capture<int32_t>, ooo, capture<int32_t>) = [](int32_t a, int32_t b) { return a * b; },
+        pattern | _                                           = 0
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(ends({2, 5, 7}), 14);
+  EXPECT_EQ(ends({}), 0);
+}
+
+TEST(Capture, nullaryHandler)
+{
+  auto const result = match(std::make_tuple(1, 2))(
+      // clang-format off
+      pattern | ds(capture<int32_t>, capture<int32_t>) = 3
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+}
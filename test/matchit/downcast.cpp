@@ -0,0 +1,233 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+using namespace matchit;
+
+namespace
+{
+  struct Node
+  {
+    virtual ~Node() = default;
+  };
+  struct Expr : Node
+  {
+  };
+  struct Literal final : Expr
+  {
+    int32_t value = 1;
+  };
+  struct Stmt : Node
+  {
+  };
+  // Both holds two Nodes, so that a Node is a Stmt by a cross cast.
+  struct Both : Expr, Stmt
+  {
+  };
+  struct Virtual : virtual Node
+  {
+  };
+
+  template <typename T>
+  int32_t kind(Node const &node)
+  {
+    static auto const kinds = matcher(
+        // clang-format off
+        pattern | as<Literal>(_) = 1,
+        pattern | as<T>(_)       = 2,
+        pattern | _              = 0
+        // clang-format on
+    );
+    return kinds(node);
+  }
+
+  // Closed hierarchy in the style of LLVM, without virtual functions.
+  struct Shape
+  {
+    enum class Kind
+    {
+      kCIRCLE,
+      kSQUARE
+    } kind;
+  };
+  struct Circle : Shape
+  {
+    static bool classof(Shape const *shape) { return shape->kind == Kind::kCIRCLE; }
+    int32_t radius;
+  };
+  struct Square : Shape
+  {
+    static bool classof(Shape const *shape) { return shape->kind == Kind::kSQUARE; }
+    int32_t side;
+  };
+
+  // Polymorphic, with a classof inherited by Puppy.
+  struct Animal
+  {
+    virtual ~Animal() = default;
+    bool isDog = false;
+  };
+  struct Dog : Animal
+  {
+    static bool classof(Animal const *animal) { return animal->isDog; }
+  };
+  struct Puppy : Dog
+  {
+  };
+} // namespace
+
+namespace matchit::impl
+{
+  template <>
+  class DeclaresClassOf<Circle> : public std::true_type
+  {
+  };
+
+  template <>
+  class DeclaresClassOf<Square> : public std::true_type
+  {
+  };
+
+  template <>
+  class DeclaresClassOf<Dog> : public std::true_type
+  {
+  };
+} // namespace matchit::impl
+
+TEST(Downcast, cached)
+{
+  Literal const literal{};
+  Expr const expr{};
+  Stmt const stmt{};
+  // Outcomes are the same when cached.
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(kind<Expr>(literal), 1);
+    EXPECT_EQ(kind<Expr>(expr), 2);
+    EXPECT_EQ(kind<Expr>(stmt), 0);
+    EXPECT_EQ(kind<Stmt>(stmt), 2);
+    EXPECT_EQ(kind<Stmt>(expr), 0);
+  }
+}
+
+TEST(Downcast, crossCast)
+{
+  Both both{};
+  Node const &viaExpr = static_cast<Expr const &>(both);
+  Node const &viaStmt = static_cast<Stmt const &>(both);
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(impl::asPointer<Expr>(viaExpr), static_cast<Expr const *>(&both));
+    EXPECT_EQ(impl::asPointer<Expr>(viaStmt), static_cast<Expr const *>(&both));
+    EXPECT_EQ(impl::asPointer<Stmt>(viaExpr), static_cast<Stmt const *>(&both));
+  }
+}
+
+TEST(Downcast, virtualBase)
+{
+  Virtual v{};
+  Node &node = v;
+  Expr const expr{};
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(impl::asPointer<Virtual>(node), &v);
+    EXPECT_EQ(impl::asPointer<Virtual>(static_cast<Node const &>(expr)), nullptr);
+  }
+}
+
+TEST(Downcast, classof)
+{
+  Circle circle{};
+  circle.kind = Shape::Kind::kCIRCLE;
+  circle.radius = 2;
+  Square square{};
+  square.kind = Shape::Kind::kSQUARE;
+  square.side = 3;
+  auto const area = [](Shape const &shape)
+  {
+    Id<int32_t> r;
+    return match(shape)(
+        // clang-format off
+        pattern | as<Circle>(app(&Circle::radius, r)) = [&] { return 3 * *r * *r; },
+        pattern | as<Square>(app(&Square::side, r))   = [&] { return *r * *r; }
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(area(circle), 12);
+  EXPECT_EQ(area(square), 9);
+  Shape &shape = circle;
+  EXPECT_EQ(impl::asPointer<Circle>(shape), &circle);
+  EXPECT_EQ(impl::asPointer<Square>(shape), nullptr);
+}
+
+TEST(Downcast, inheritedClassof)
+{
+  static_assert(impl::viaClassOfV<Dog, Animal> && !impl::viaClassOfV<Puppy, Animal>);
+  Dog dog{};
+  dog.isDog = true;
+  Puppy puppy{};
+  puppy.isDog = true;
+  Animal const &animal = dog;
+  EXPECT_EQ(impl::asPointer<Dog>(animal), &dog);
+  // Dog::classof tells nothing about Puppy, so it is cast dynamically.
+  EXPECT_EQ(impl::asPointer<Puppy>(animal), nullptr);
+  EXPECT_EQ(impl::asPointer<Puppy>(static_cast<Animal const &>(puppy)), &puppy);
+}
+
+TEST(Downcast, typeSwitch)
+{
+  Literal one{};
+  Literal two{};
+  two.value = 2;
+  Expr const expr{};
+  Stmt const stmt{};
+  Both const both{};
+  auto const names = matcher(
+      // clang-format off
+      pattern | as<Literal>(app(&Literal::value, 2)) = "two",
+      pattern | as<Stmt>(_)                          = "stmt",
+      pattern | as<Expr>(_)                          = "expr",
+      pattern | _                                    = "node"
+      // clang-format on
+  );
+  auto const name = [&](Node const &node) { return names(node); };
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_STREQ(name(two), "two");
+    // Arms after the first one that can match are still tried.
+    EXPECT_STREQ(name(one), "expr");
+    EXPECT_STREQ(name(expr), "expr");
+    EXPECT_STREQ(name(stmt), "stmt");
+    EXPECT_STREQ(name(Node{}), "node");
+    EXPECT_STREQ(name(static_cast<Expr const &>(both)), "stmt");
+    EXPECT_STREQ(name(static_cast<Stmt const &>(both)), "stmt");
+  }
+}
+
+TEST(Downcast, threads)
+{
+  Literal const literal{};
+  Expr const expr{};
+  Stmt const stmt{};
+  std::vector<Node const *> const nodes = {&literal, &expr, &stmt};
+  std::vector<std::thread> threads;
+  std::vector<int32_t> wrong(4);
+  for (int32_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+        [&, t]
+        {
+          for (size_t i = 0; i < 3000; ++i)
+          {
+            auto const &node = *nodes[i % nodes.size()];
+            auto const expected = i % 3 == 0 ? 1 : i % 3 == 1 ? 2 : 0;
+            wrong[static_cast<size_t>(t)] += kind<Expr>(node) != expected;
+          }
+        });
+  }
+  for (auto &t : threads)
+  {
+    t.join();
+  }
+  EXPECT_EQ(wrong, std::vector<int32_t>(4));
+}
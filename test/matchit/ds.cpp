@@ -1,7 +1,11 @@
 #include "matchit.h"
 #include <gtest/gtest.h>
+#include <forward_list>
+#include <iterator>
 #include <list>
+#include <string>
 #include <utility>
+#include <vector>
 
 using namespace matchit;
 
@@ -309,4 +313,158 @@ TEST(Ds, mapOooAtBinder)
                                              auto const expected = {std::make_pair(456, "b"), std::make_pair(789, "c")};
                                              expectRange(*subrange, expected);
                                            });
-}
\ No newline at end of file
+}
+TEST(Ds, forwardListOoo)
+{
+  EXPECT_TRUE(matched(std::forward_list<int32_t>{123, 456}, ds(123, 456)));
+  EXPECT_FALSE(matched(std::forward_list<int32_t>{123, 456}, ds(123)));
+  EXPECT_FALSE(matched(std::forward_list<int32_t>{123}, ds(123, 456)));
+  EXPECT_TRUE(matched(std::forward_list<int32_t>{}, ds(ooo)));
+  EXPECT_TRUE(matched(std::forward_list<int32_t>{123, 456}, ds(ooo, 456)));
+  EXPECT_TRUE(matched(std::forward_list<int32_t>{123, 789, 456}, ds(123, ooo, 456)));
+  EXPECT_FALSE(matched(std::forward_list<int32_t>{123}, ds(123, ooo, 456)));
+  EXPECT_FALSE(matched(std::forward_list<int32_t>{456}, ds(123, ooo, 456)));
+
+  Id<SubrangeT<std::forward_list<int32_t> const>> subrange;
+  auto const list = std::forward_list<int32_t>{1, 2, 3, 4, 5};
+  match(list)(pattern | ds(1, subrange.at(ooo), 4, 5) = [&]
+              {
+                auto const expected = {2, 3};
+                expectRange(*subrange, expected);
+              });
+}
+
+// A forward range without size(), counting how often its iterators advance.
+class Counted
+{
+  std::forward_list<int32_t> mValues;
+  mutable size_t mSteps = 0;
+
+public:
+  class Iterator
+  {
+    std::forward_list<int32_t>::const_iterator mIt;
+    size_t *mSteps;
+
+  public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = int32_t;
+    using difference_type = std::ptrdiff_t;
+    using pointer = int32_t const *;
+    using reference = int32_t const &;
+
+    Iterator(std::forward_list<int32_t>::const_iterator it, size_t *steps)
+        : mIt{it}, mSteps{steps}
+    {
+    }
+    reference operator*() const { return *mIt; }
+    Iterator &operator++()
+    {
+      ++mIt;
+      ++*mSteps;
+      return *this;
+    }
+    bool operator==(Iterator const &other) const { return mIt == other.mIt; }
+    bool operator!=(Iterator const &other) const { return mIt != other.mIt; }
+  };
+
+  explicit Counted(std::initializer_list<int32_t> values) : mValues{values} {}
+  Iterator begin() const { return {mValues.begin(), &mSteps}; }
+  Iterator end() const { return {mValues.end(), &mSteps}; }
+  size_t steps() const { return mSteps; }
+};
+
+TEST(Ds, walkOnce)
+{
+  Counted const values{1, 2, 3, 4, 5, 6, 7, 8};
+  EXPECT_TRUE(matched(values, ds(1, 2, ooo, 7, 8)));
+  // Elements are passed by the lead of ooo, then by the end of ooo and the
+  // patterns around it.
+  EXPECT_EQ(values.steps(), size_t{14});
+
+  Counted const few{1, 2, 3};
+  EXPECT_FALSE(matched(few, ds(1, 2)));
+  EXPECT_TRUE(matched(few, ds(1, 2, 3)));
+  EXPECT_FALSE(matched(few, ds(1, 2, 3, 4)));
+  EXPECT_FALSE(matched(few, ds(1, 2, ooo, 3, 4)));
+}
+
+TEST(Ds, manyOoo)
+{
+  auto const request = std::string{"POST /api HTTP/1.1"};
+  EXPECT_TRUE(matched(request, ds(ooo, '/', 'a', 'p', 'i', ooo)));
+  EXPECT_TRUE(matched(request, ds('P', ooo, ' ', ooo, '1')));
+  EXPECT_FALSE(matched(request, ds(ooo, 'G', 'E', 'T', ooo)));
+  EXPECT_FALSE(matched(request, ds('P', ooo, 'P', 'O', ooo)));
+  EXPECT_TRUE(matched(request, ds(ooo, 'H', 'T', 'T', 'P', '/', '1', '.', '1', ooo)));
+  EXPECT_FALSE(matched(request, ds(ooo, 'H', 'T', 'T', 'P', '/', '2', '.', '0', ooo)));
+  EXPECT_TRUE(matched(request, ds(ooo, ooo)));
+  EXPECT_TRUE(matched(std::string{}, ds(ooo, ooo)));
+  EXPECT_FALSE(matched(std::string{"ab"}, ds('a', ooo, 'b', ooo, 'b')));
+
+  auto const list = std::list<int32_t>{1, 2, 3, 4, 5, 6};
+  EXPECT_TRUE(matched(list, ds(1, ooo, 3, 4, ooo, 6)));
+  EXPECT_TRUE(matched(list, ds(ooo, 2, ooo, 4, ooo)));
+  EXPECT_FALSE(matched(list, ds(ooo, 4, ooo, 2, ooo)));
+}
+
+TEST(Ds, manyOooBinders)
+{
+  auto const line = std::string{"key = value; rest"};
+  Id<SubrangeT<decltype(line)>> key;
+  Id<SubrangeT<decltype(line)>> value;
+  Id<SubrangeT<decltype(line)>> rest;
+  EXPECT_TRUE(match(line)(
+      pattern | ds(key.at(ooo), ' ', '=', ' ', value.at(ooo), ';', ' ', rest.at(ooo)) =
+          [&]
+      {
+        expectRange(*key, std::string{"key"});
+        expectRange(*value, std::string{"value"});
+        expectRange(*rest, std::string{"rest"});
+        return true;
+      },
+      pattern | _ = false));
+
+  // The patterns between two ooo match where they first do.
+  auto const vec = std::vector<int32_t>{0, 1, 0, 1, 0};
+  Id<SubrangeT<decltype(vec)>> first;
+  Id<SubrangeT<decltype(vec)>> second;
+  match(vec)(pattern | ds(first.at(ooo), 1, second.at(ooo)) = [&]
+             {
+               expectRange(*first, std::vector<int32_t>{0});
+               expectRange(*second, std::vector<int32_t>{0, 1, 0});
+             },
+             pattern | ds(first.at(ooo), 1, ooo, 1, second.at(ooo)) = [] { FAIL(); });
+  match(vec)(pattern | ds(ooo, 1, first.at(ooo), 1, second.at(ooo)) = [&]
+             {
+               expectRange(*first, std::vector<int32_t>{0});
+               expectRange(*second, std::vector<int32_t>{0});
+             });
+}
+
+TEST(Ds, manyOooPatterns)
+{
+  auto const vec = std::vector<int32_t>{3, 1, 4, 1, 5, 9, 2, 6};
+  Id<int32_t> x;
+  Id<SubrangeT<decltype(vec)>> before;
+  match(vec)(pattern | ds(before.at(ooo), x, 5, ooo) = [&]
+             {
+               EXPECT_EQ(*x, 1);
+               expectRange(*before, std::vector<int32_t>{3, 1, 4});
+             });
+  EXPECT_TRUE(matched(vec, ds(ooo, _ < 2, _ > 4, ooo, 6)));
+  EXPECT_FALSE(matched(vec, ds(ooo, _ > 9, ooo)));
+}
+
+TEST(Ds, idInMiddleSegment)
+{
+  auto const vec = std::vector<int32_t>{1, 2, 3};
+  Id<int32_t> x;
+  auto const result = match(vec)(
+      // clang-format off
+      pattern | ds(ooo, x, 3, ooo) = [&] { return *x; },
+      pattern | _                  = expr(-1)
+      // clang-format on
+  );
+  EXPECT_EQ(result, 2);
+}
@@ -0,0 +1,132 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <variant>
+using namespace matchit;
+
+enum class Color
+{
+  kRED,
+  kGREEN,
+  kBLUE
+};
+
+constexpr auto enumerators(Color)
+{
+  return std::array{Color::kRED, Color::kGREEN, Color::kBLUE};
+}
+
+using Number = std::variant<int32_t, double, std::string>;
+
+auto const kInt = pattern | as<int32_t>(_) = []() noexcept { return 1; };
+auto const kDouble = pattern | as<double>(_) = []() noexcept { return 2; };
+auto const kString = pattern | as<std::string>(_) = []() noexcept { return 3; };
+
+static_assert(exhaustive<int32_t>(pattern | 1 = 1, pattern | _ = 2));
+static_assert(!exhaustive<int32_t>(pattern | 1 = 1, pattern | 2 = 2));
+static_assert(exhaustive<Number>(kInt, kDouble, kString));
+static_assert(exhaustive<Number const &>(kString, kDouble, kInt));
+static_assert(!exhaustive<Number>(kInt, kDouble));
+static_assert(!exhaustive<Number>(pattern | as<int32_t>(1) = 1, kDouble, kString));
+static_assert(exhaustive<Color>(
+    // clang-format off
+    pattern | lit<Color::kRED>                      = 1,
+    pattern | or_(lit<Color::kGREEN>, lit<Color::kBLUE>) = 2
+    // clang-format on
+    ));
+static_assert(!exhaustive<Color>(pattern | lit<Color::kRED> = 1,
+                                 pattern | lit<Color::kGREEN> = 2));
+// Values only known at run time prove nothing.
+static_assert(!exhaustive<Color>(pattern | Color::kRED = 1, pattern | Color::kGREEN = 2,
+                                 pattern | Color::kBLUE = 3));
+
+// Arms asserted exhaustive, so that a new enumerator breaks the build.
+constexpr auto kRed = pattern | lit<Color::kRED> = 1;
+constexpr auto kOthers = pattern | or_(lit<Color::kGREEN>, lit<Color::kBLUE>) = 2;
+static_assert(exhaustive<Color>(kRed, kOthers));
+static_assert(!exhaustive<Color>(kOthers));
+
+constexpr int32_t shortColorCode(Color color)
+{
+  return match(color)(kRed, kOthers);
+}
+static_assert(shortColorCode(Color::kBLUE) == 2);
+
+constexpr int32_t colorCode(Color color)
+{
+  return match(color)(
+      // clang-format off
+      pattern | lit<Color::kRED>   = 1,
+      pattern | lit<Color::kGREEN> = 2,
+      pattern | lit<Color::kBLUE>  = 3
+      // clang-format on
+  );
+}
+static_assert(colorCode(Color::kGREEN) == 2);
+
+auto const kOther = pattern | _ = []() noexcept { return 0; };
+
+TEST(Exhaustive, variantNoexcept)
+{
+  Number const n = std::string{"three"};
+  // Valueless variants are matched by no as<T> arm.
+  static_assert(!noexcept(match(n)(kInt, kDouble, kString)));
+  static_assert(noexcept(match(n)(kInt, kDouble, kOther)));
+  static_assert(noexcept(tryMatch(n)(kInt, kDouble)));
+  EXPECT_EQ(match(n)(kInt, kDouble, kString), 3);
+  EXPECT_EQ(match(Number{1.5})(kInt, kDouble, kString), 2);
+}
+
+struct ThrowOnCopy
+{
+  ThrowOnCopy() = default;
+  ThrowOnCopy(ThrowOnCopy const &) { throw std::runtime_error{"copy"}; }
+  ThrowOnCopy &operator=(ThrowOnCopy const &) = default;
+};
+
+TEST(Exhaustive, valueless)
+{
+  std::variant<int32_t, ThrowOnCopy> v;
+  ThrowOnCopy const t{};
+  EXPECT_THROW(v.emplace<ThrowOnCopy>(t), std::runtime_error);
+  ASSERT_TRUE(v.valueless_by_exception());
+  auto const f = [](auto const &value)
+  {
+    return match(value)(
+        // clang-format off
+        pattern | as<int32_t>(_)     = 1,
+        pattern | as<ThrowOnCopy>(_) = 2
+        // clang-format on
+    );
+  };
+  EXPECT_THROW(f(v), std::logic_error);
+  EXPECT_EQ(f(std::variant<int32_t, ThrowOnCopy>{3}), 1);
+}
+
+TEST(Exhaustive, throwingHandlers)
+{
+  auto const mayThrow = pattern | as<std::string>(_) = [] { return 3; };
+  static_assert(!noexcept(match(Number{1})(kInt, kDouble, mayThrow)));
+  EXPECT_EQ(match(Number{1})(kInt, kDouble, mayThrow), 1);
+}
+
+TEST(Exhaustive, enumerators)
+{
+  auto const red = pattern | lit<Color::kRED> = 'r';
+  auto const others = pattern | or_(lit<Color::kGREEN>, lit<Color::kBLUE>) = 'o';
+  // Enum values of no enumerator are valid.
+  static_assert(!noexcept(match(Color::kBLUE)(red, others)));
+  EXPECT_EQ(match(Color::kRED)(red, others), 'r');
+  EXPECT_EQ(match(Color::kBLUE)(red, others), 'o');
+  EXPECT_THROW(match(static_cast<Color>(7))(red, others), std::logic_error);
+  EXPECT_EQ(colorCode(Color::kBLUE), 3);
+}
+
+TEST(Exhaustive, matcher)
+{
+  auto const m = matcher(kInt, kDouble, kOther);
+  static_assert(noexcept(m(std::declval<Number const &>())));
+  static_assert(!noexcept(matcher<impl::NoInstrumentation>(kInt)(std::declval<Number>())));
+  EXPECT_EQ(m(Number{2}), 1);
+}
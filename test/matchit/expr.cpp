@@ -1,4 +1,13 @@
+// mixedSignednessIntervals compares unsigned values with signed bounds on
+// purpose.
+#if defined(__GNUC__)
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wsign-compare"
+#endif
 #include "matchit.h"
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
 #include <gtest/gtest.h>
 using namespace matchit;
 
@@ -28,3 +37,132 @@ TEST(Expr, Unary)
   EXPECT_EQ((_ || false)(true), true);
   EXPECT_EQ((_ && false)(true), false);
 }
+
+TEST(Expr, Interval)
+{
+  EXPECT_EQ((_ < 2)(1), true);
+  EXPECT_EQ((_ <= 2)(2), true);
+  EXPECT_EQ((2 < _)(2), false);
+  EXPECT_EQ((2 >= _)(2), true);
+  EXPECT_EQ((0 <= _ && _ < 2)(2), false);
+  EXPECT_EQ((_ > 0 && _ >= 0)(0), false);
+  EXPECT_EQ(!(0 <= _ && _ < 2)(-1), true);
+  static_assert((1 <= _ && _ <= 3)(3));
+}
+
+constexpr auto bucket(double x)
+{
+  return match(x)(
+      // clang-format off
+      pattern | (_ < 0.0)               = 0,
+      pattern | (0.0 <= _ && _ < 10.0)  = 1,
+      pattern | (10.0 <= _ && _ <= 20.0) = 2,
+      pattern | (_ > 20.0)              = 3,
+      pattern | _                       = -1
+      // clang-format on
+  );
+}
+
+static_assert(bucket(10.0) == 2);
+
+TEST(Expr, sortedIntervals)
+{
+  EXPECT_EQ(bucket(-1.0), 0);
+  EXPECT_EQ(bucket(0.0), 1);
+  EXPECT_EQ(bucket(9.5), 1);
+  EXPECT_EQ(bucket(10.0), 2);
+  EXPECT_EQ(bucket(20.0), 2);
+  EXPECT_EQ(bucket(20.5), 3);
+  EXPECT_EQ(bucket(0.0 / 0.0), -1);
+}
+
+// Matchers check the order of their intervals once and binary search them.
+TEST(Expr, sortedIntervalsMatcher)
+{
+  auto const m = matcher(
+      // clang-format off
+      pattern | (_ < 0)             = 0,
+      pattern | (0 <= _ && _ < 10)  = 1,
+      pattern | (10 <= _ && _ < 20) = 2,
+      pattern | (_ >= 30)           = 3,
+      pattern | _                   = -1
+      // clang-format on
+  );
+  EXPECT_EQ(m(-1), 0);
+  EXPECT_EQ(m(0), 1);
+  EXPECT_EQ(m(19), 2);
+  EXPECT_EQ(m(25), -1);
+  EXPECT_EQ(m(30), 3);
+}
+
+TEST(Expr, mixedSignednessIntervals)
+{
+  auto const f = [](auto v)
+  {
+    return match(v)(
+        // clang-format off
+        pattern | (_ < -1) = 0,
+        pattern | (_ >= 0) = 1,
+        pattern | _        = 2
+        // clang-format on
+    );
+  };
+  auto const m = matcher(
+      // clang-format off
+      pattern | (_ < -1) = 0,
+      pattern | (_ >= 0) = 1,
+      pattern | _        = 2
+      // clang-format on
+  );
+  for (auto const v : {0U, 5U, 4000000000U})
+  {
+    EXPECT_EQ(m(v), f(v));
+  }
+  for (auto const v : {int64_t{-5}, int64_t{-1}, int64_t{5}})
+  {
+    EXPECT_EQ(m(v), f(v));
+  }
+  EXPECT_EQ(m(5U), 0);
+  EXPECT_EQ(m(int64_t{-1}), 2);
+}
+
+TEST(Expr, overlappingIntervals)
+{
+  auto const f = [](int32_t x)
+  {
+    return match(x)(
+        // clang-format off
+        pattern | (_ > 10) = 3,
+        pattern | (_ > 5)  = 2,
+        pattern | (_ > 0)  = 1,
+        pattern | _        = 0
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(f(11), 3);
+  EXPECT_EQ(f(6), 2);
+  EXPECT_EQ(f(1), 1);
+  EXPECT_EQ(f(0), 0);
+}
+
+TEST(Expr, gapsBetweenIntervals)
+{
+  int32_t lo = 10;
+  auto const f = [&](int32_t x)
+  {
+    return match(x)(
+        // clang-format off
+        pattern | (0 <= _ && _ < 5)   = 1,
+        pattern | (lo <= _ && _ < 20) = 2,
+        pattern | (_ >= 30)           = 3,
+        pattern | _                   = 0
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(f(-1), 0);
+  EXPECT_EQ(f(4), 1);
+  EXPECT_EQ(f(5), 0);
+  EXPECT_EQ(f(10), 2);
+  EXPECT_EQ(f(25), 0);
+  EXPECT_EQ(f(30), 3);
+}
@@ -1,6 +1,7 @@
 #include "matchit.h"
 #include <gtest/gtest.h>
 #include <optional>
+#include <vector>
 using namespace matchit;
 
 TEST(Id, matchValue)
@@ -307,3 +308,100 @@ TEST(Id, move)
   auto y = std::move(*x);
   EXPECT_TRUE((*x).empty());
 }
+
+TEST(Id, valueThenPointer)
+{
+  Id<std::string> s;
+  auto const exclaim = [](std::string const &str) { return str + "!"; };
+  std::string const abc = "abc";
+  auto const m = [&](std::string const &str)
+  {
+    return match(str)(
+        // clang-format off
+        pattern | app(exclaim, and_(s, std::string{"ab!"})) = [&] { return *s; },
+        pattern | s                                         = [&] { return *s; }
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(m("ab"), "ab!");
+  EXPECT_EQ(m(abc), "abc");
+  EXPECT_EQ(&*s, &abc);
+}
+
+// Counts allocations, to check that binding values does not copy them.
+template <typename T>
+class CountingAllocator
+{
+public:
+  using value_type = T;
+  static inline int32_t allocations = 0;
+
+  CountingAllocator() = default;
+  template <typename U>
+  CountingAllocator(CountingAllocator<U> const &)
+  {
+  }
+  T *allocate(size_t n)
+  {
+    ++allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T *p, size_t n) { std::allocator<T>{}.deallocate(p, n); }
+  template <typename U>
+  bool operator==(CountingAllocator<U> const &) const
+  {
+    return true;
+  }
+  template <typename U>
+  bool operator!=(CountingAllocator<U> const &) const
+  {
+    return false;
+  }
+};
+
+using Vec = std::vector<int32_t, CountingAllocator<int32_t>>;
+
+TEST(Id, moveRvalue)
+{
+  Id<Vec> v;
+  auto const before = CountingAllocator<int32_t>::allocations;
+  auto const size = match(Vec(100))(
+      // clang-format off
+      pattern | and_(v, app(&Vec::empty, true)) = size_t{0},
+      pattern | v                               = [&] { return (*v).size(); }
+      // clang-format on
+  );
+  EXPECT_EQ(size, size_t{100});
+  EXPECT_EQ(CountingAllocator<int32_t>::allocations - before, 1);
+}
+
+TEST(Id, borrowRvalue)
+{
+  Id<Vec const &> v;
+  Vec vec(100);
+  auto const before = CountingAllocator<int32_t>::allocations;
+  auto const *const data = match(std::move(vec))(
+      // clang-format off
+      pattern | v = [&] { return (*v).data(); }
+      // clang-format on
+  );
+  EXPECT_EQ(data, vec.data());
+  EXPECT_EQ(CountingAllocator<int32_t>::allocations - before, 0);
+}
+
+TEST(Id, borrowAppResult)
+{
+  Id<Vec const &> v;
+  Id<Vec> w;
+  auto const twice = [](Vec const &vec) { return Vec(vec.size() * 2); };
+  Vec const vec(100);
+  auto const before = CountingAllocator<int32_t>::allocations;
+  auto const size = match(vec)(
+      // clang-format off
+      pattern | app(twice, and_(v, w)) = [&] { return (*v).size() + (*w).size(); }
+      // clang-format on
+  );
+  EXPECT_EQ(size, size_t{400});
+  // Only the result of twice is allocated.
+  EXPECT_EQ(CountingAllocator<int32_t>::allocations - before, 1);
+}
@@ -0,0 +1,137 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <iterator>
+#include <sstream>
+#include <string>
+#include <vector>
+using namespace matchit;
+
+static_assert(impl::isRangeV<InputRange<std::istreambuf_iterator<char>>>);
+
+enum class Format
+{
+  kELF,
+  kPE,
+  kSCRIPT,
+  kUNKNOWN
+};
+
+template <typename Range>
+Format format(Range const &header)
+{
+  return match(header)(
+      // clang-format off
+      pattern | ds('M', 'Z', ooo)                 = Format::kPE,
+      pattern | ds('\x7f', 'E', 'L', 'F', ooo)    = Format::kELF,
+      pattern | ds('#', '!', ooo)                 = Format::kSCRIPT,
+      pattern | _                                 = Format::kUNKNOWN
+      // clang-format on
+  );
+}
+
+TEST(InputRange, readsHeaderOnly)
+{
+  std::istringstream in{"\x7f" "ELF and a long payload"};
+  auto const header = inputRange(std::istreambuf_iterator<char>{in});
+  EXPECT_EQ(format(header), Format::kELF);
+  EXPECT_EQ(header.consumed(), size_t{4});
+  EXPECT_EQ(*header.rest(), ' ');
+  std::string rest;
+  std::getline(in, rest);
+  EXPECT_EQ(rest, " and a long payload");
+}
+
+TEST(InputRange, sameElementsForAllArms)
+{
+  std::istringstream in{"#!/bin/sh"};
+  auto const header = inputRange(std::istreambuf_iterator<char>{in});
+  EXPECT_EQ(format(header), Format::kSCRIPT);
+  EXPECT_EQ(header.consumed(), size_t{2});
+
+  std::istringstream text{"text"};
+  auto const other = inputRange(std::istreambuf_iterator<char>{text});
+  EXPECT_EQ(format(other), Format::kUNKNOWN);
+  EXPECT_EQ(other.consumed(), size_t{1});
+
+  std::istringstream empty;
+  EXPECT_EQ(format(inputRange(std::istreambuf_iterator<char>{empty})), Format::kUNKNOWN);
+}
+
+TEST(InputRange, exactLength)
+{
+  std::istringstream in{"abc"};
+  auto const range = inputRange(std::istreambuf_iterator<char>{in});
+  EXPECT_FALSE(matched(range, ds('a', 'b')));
+  // Telling there are more elements does not read them.
+  EXPECT_EQ(range.consumed(), size_t{2});
+  EXPECT_TRUE(matched(range, ds('a', 'b', 'c')));
+  EXPECT_FALSE(matched(range, ds('a', 'b', 'c', 'd')));
+  EXPECT_TRUE(matched(range, ds(ooo, 'b', 'c')));
+}
+
+TEST(InputRange, oooBinder)
+{
+  std::istringstream in{"abcd"};
+  auto const range = inputRange(std::istreambuf_iterator<char>{in});
+  Id<SubrangeT<decltype(range)>> middle;
+  match(range)(pattern | ds('a', middle.at(ooo), 'd') = [&]
+               {
+                 auto const expected = std::string{"bc"};
+                 EXPECT_TRUE(std::equal((*middle).begin(), (*middle).end(), expected.begin(),
+                                        expected.end()));
+               });
+}
+
+// Reads the bytes of chunks received one after another.
+class ChunkIterator
+{
+  std::vector<std::string> const *mChunks = nullptr;
+  size_t mChunk = 0;
+  size_t mOffset = 0;
+
+  void skipEmpty()
+  {
+    while (mChunk < mChunks->size() && mOffset == (*mChunks)[mChunk].size())
+    {
+      ++mChunk;
+      mOffset = 0;
+    }
+  }
+
+public:
+  using iterator_category = std::input_iterator_tag;
+  using value_type = char;
+  using difference_type = std::ptrdiff_t;
+  using pointer = char const *;
+  using reference = char const &;
+
+  ChunkIterator() = default;
+  explicit ChunkIterator(std::vector<std::string> const &chunks) : mChunks{&chunks}
+  {
+    skipEmpty();
+  }
+  reference operator*() const { return (*mChunks)[mChunk][mOffset]; }
+  ChunkIterator &operator++()
+  {
+    ++mOffset;
+    skipEmpty();
+    return *this;
+  }
+  bool atEnd() const { return mChunks == nullptr || mChunk == mChunks->size(); }
+  bool operator==(ChunkIterator const &other) const
+  {
+    return atEnd() && other.atEnd();
+  }
+  bool operator!=(ChunkIterator const &other) const { return !(*this == other); }
+};
+
+TEST(InputRange, chunks)
+{
+  std::vector<std::string> const chunks = {"\x7f" "E", "", "L", "F rest"};
+  auto const header = inputRange(ChunkIterator{chunks});
+  EXPECT_EQ(format(header), Format::kELF);
+  EXPECT_EQ(header.consumed(), size_t{4});
+
+  std::vector<std::string> const mz = {"M", "Z"};
+  EXPECT_EQ(format(inputRange(ChunkIterator{mz})), Format::kPE);
+}
@@ -0,0 +1,127 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <sstream>
+#include <thread>
+#include <vector>
+using namespace matchit;
+
+namespace
+{
+  struct PairSite;
+  struct LiteralSite;
+  struct ThreadSite;
+
+  // Records the order of hooks.
+  class Trace : public NoInstrumentation
+  {
+  public:
+    inline static std::vector<std::string> events;
+    static void enter(size_t nbArms) { events.push_back("enter " + std::to_string(nbArms)); }
+    static void attempt(size_t arm) { events.push_back("attempt " + std::to_string(arm)); }
+    static void hit(size_t arm) { events.push_back("hit " + std::to_string(arm)); }
+    static void miss(size_t arm, int32_t depth)
+    {
+      events.push_back("miss " + std::to_string(arm) + " at " + std::to_string(depth));
+    }
+    static void noMatch() { events.push_back("no match"); }
+  };
+} // namespace
+
+TEST(Instrument, hooks)
+{
+  Trace::events.clear();
+  auto const result = match<Trace>(1, 2)(
+      // clang-format off
+      pattern | ds(1, 3) = 1,
+      pattern | ds(2, _) = 2,
+      pattern | _        = 3
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+  EXPECT_EQ(Trace::events,
+            (std::vector<std::string>{"enter 3", "attempt 0", "miss 0 at 1", "attempt 1",
+                                      "miss 1 at 1", "attempt 2", "hit 2"}));
+
+  Trace::events.clear();
+  match<Trace>(5)(pattern | 1 = [] {});
+  EXPECT_EQ(Trace::events,
+            (std::vector<std::string>{"enter 1", "attempt 0", "miss 0 at 0", "no match"}));
+}
+
+TEST(Instrument, counters)
+{
+  using Counters = ArmCounters<PairSite>;
+  Counters::reset();
+  for (int32_t i = 0; i < 10; ++i)
+  {
+    match<Counters>(i % 3, i % 5)(
+        // clang-format off
+        pattern | ds(1, 2)                  = 1,
+        pattern | ds(_, app(_ * 2, 8))      = 2,
+        pattern | ds(_, _)                  = 3
+        // clang-format on
+    );
+  }
+  EXPECT_EQ(Counters::matches(), 10);
+  EXPECT_EQ(Counters::noMatches(), 0);
+  EXPECT_EQ(Counters::nbArms(), 3);
+  EXPECT_EQ(Counters::arm(0).attempts, 10);
+  EXPECT_EQ(Counters::arm(0).hits, 1);
+  EXPECT_EQ(Counters::arm(0).misses[1], 9);
+  EXPECT_EQ(Counters::arm(1).attempts, 9);
+  EXPECT_EQ(Counters::arm(1).hits, 2);
+  EXPECT_EQ(Counters::arm(1).misses[2], 7);
+  EXPECT_EQ(Counters::arm(2).hits, 7);
+
+  std::ostringstream os;
+  Counters::report(os);
+  EXPECT_EQ(os.str().substr(0, os.str().find('\n')), "matches: 10, no match: 0");
+}
+
+TEST(Instrument, matcher)
+{
+  using Counters = ArmCounters<LiteralSite>;
+  Counters::reset();
+  auto const m = matcher<Counters>(
+      // clang-format off
+      pattern | lit<1>  = 1,
+      pattern | lit<2>  = 2,
+      pattern | (_ > 5) = 3
+      // clang-format on
+  );
+  for (int32_t i = 0; i < 10; ++i)
+  {
+    static_cast<void>(m.tryMatch(i));
+  }
+  EXPECT_EQ(Counters::arm(0).hits, 1);
+  EXPECT_EQ(Counters::arm(1).hits, 1);
+  EXPECT_EQ(Counters::arm(2).attempts, 8);
+  EXPECT_EQ(Counters::arm(2).hits, 4);
+  EXPECT_EQ(Counters::noMatches(), 4);
+}
+
+TEST(Instrument, threads)
+{
+  using Counters = ArmCounters<ThreadSite>;
+  Counters::reset();
+  auto const m = matcher<Counters>(pattern | (_ < 0) = -1, pattern | _ = 1);
+  std::vector<std::thread> threads;
+  for (int32_t t = 0; t < 4; ++t)
+  {
+    threads.emplace_back(
+        [&]
+        {
+          for (int32_t i = 0; i < 1000; ++i)
+          {
+            m(i % 2 == 0 ? i : -i);
+          }
+        });
+  }
+  for (auto &t : threads)
+  {
+    t.join();
+  }
+  EXPECT_EQ(Counters::matches(), 4000);
+  EXPECT_EQ(Counters::arm(0).hits, 2000);
+  EXPECT_EQ(Counters::arm(1).hits, 2000);
+}
@@ -0,0 +1,185 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+using namespace matchit;
+
+enum class Op
+{
+  Add,
+  Sub,
+  Mul,
+  Div
+};
+
+constexpr int32_t dense(int32_t x)
+{
+  return match(x)(
+      // clang-format off
+      pattern | lit<1> = 10,
+      pattern | lit<2> = 20,
+      pattern | lit<4> = 40,
+      pattern | lit<2> = -2,
+      pattern | _      = -1
+      // clang-format on
+  );
+}
+
+static_assert(dense(1) == 10);
+static_assert(dense(2) == 20);
+static_assert(dense(3) == -1);
+static_assert(dense(4) == 40);
+
+TEST(Literal, dense)
+{
+  EXPECT_EQ(dense(0), -1);
+  EXPECT_EQ(dense(1), 10);
+  EXPECT_EQ(dense(2), 20);
+  EXPECT_EQ(dense(3), -1);
+  EXPECT_EQ(dense(4), 40);
+  EXPECT_EQ(dense(-4), -1);
+}
+
+TEST(Literal, sparse)
+{
+  auto const sparse = [](int64_t x)
+  {
+    return match(x)(
+        // clang-format off
+        pattern | lit<-300>    = 1,
+        pattern | lit<7>       = 2,
+        pattern | lit<100000>  = 3,
+        pattern | lit<INT64_MIN> = 4,
+        pattern | lit<INT64_MAX> = 5,
+        pattern | _            = 0
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(sparse(-300), 1);
+  EXPECT_EQ(sparse(7), 2);
+  EXPECT_EQ(sparse(100000), 3);
+  EXPECT_EQ(sparse(INT64_MIN), 4);
+  EXPECT_EQ(sparse(INT64_MAX), 5);
+  EXPECT_EQ(sparse(8), 0);
+  EXPECT_EQ(sparse(-1), 0);
+}
+
+TEST(Literal, enumAndHandlers)
+{
+  auto const toOp = [](char c)
+  {
+    Id<char> token;
+    return match(c)(
+        // clang-format off
+        pattern | lit<'+'> = Op::Add,
+        pattern | lit<'-'> = [] { return Op::Sub; },
+        pattern | lit<'*'> = Op::Mul,
+        pattern | token    = [&] { return *token == '/' ? Op::Div : Op::Add; }
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(toOp('+'), Op::Add);
+  EXPECT_EQ(toOp('-'), Op::Sub);
+  EXPECT_EQ(toOp('*'), Op::Mul);
+  EXPECT_EQ(toOp('/'), Op::Div);
+
+  auto const arity = [](Op op)
+  {
+    return match(op)(
+        // clang-format off
+        pattern | lit<Op::Sub> = 1,
+        pattern | lit<Op::Div> = 2,
+        pattern | _            = 3
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(arity(Op::Sub), 1);
+  EXPECT_EQ(arity(Op::Div), 2);
+  EXPECT_EQ(arity(Op::Add), 3);
+}
+
+TEST(Literal, statement)
+{
+  int32_t hit = 0;
+  for (auto i = 0; i < 4; ++i)
+  {
+    match(i)(
+        // clang-format off
+        pattern | lit<1> = [&] { hit += 1; },
+        pattern | lit<3> = [&] { hit += 3; }
+        // clang-format on
+    );
+  }
+  EXPECT_EQ(hit, 4);
+}
+
+TEST(Literal, noMatch)
+{
+  EXPECT_THROW(match(4)(pattern | lit<1> = true, pattern | lit<2> = false),
+               std::logic_error);
+}
+
+template <typename String>
+constexpr int32_t command(String const &s)
+{
+  return match(s)(
+      // clang-format off
+      pattern | "get"    = 1,
+      pattern | "put"    = 2,
+      pattern | ""       = 3,
+      pattern | "delete" = 4,
+      pattern | "put"    = -2,
+      pattern | "gets"   = 5,
+      pattern | _        = 0
+      // clang-format on
+  );
+}
+
+static_assert(command(std::string_view{"put"}) == 2);
+static_assert(command(std::string_view{"post"}) == 0);
+
+TEST(StringLiteral, subjects)
+{
+  EXPECT_EQ(command(std::string{"get"}), 1);
+  EXPECT_EQ(command(std::string_view{"put"}), 2);
+  EXPECT_EQ(command(std::string{}), 3);
+  EXPECT_EQ(command(std::string{"delete"}), 4);
+  EXPECT_EQ(command(std::string{"gets"}), 5);
+  EXPECT_EQ(command(std::string{"got"}), 0);
+  EXPECT_EQ(command(std::string{"deleted"}), 0);
+
+  // Compare contents rather than addresses.
+  char buffer[] = "gets";
+  EXPECT_EQ(command(static_cast<char const *>(buffer)), 5);
+  EXPECT_EQ(command(static_cast<char const *>(nullptr)), 0);
+}
+
+TEST(StringLiteral, single)
+{
+  std::string const s = "abc";
+  EXPECT_TRUE(match(s)(pattern | "abc" = true, pattern | _ = false));
+  EXPECT_TRUE(matched(s.c_str(), or_(std::string{"x"}, std::string{"abc"})));
+}
+
+TEST(StringLiteral, shorterThanArray)
+{
+  char const buf[16] = "abc";
+  std::string const s = "abc";
+  EXPECT_TRUE(match(s)(pattern | buf = true, pattern | _ = false));
+  EXPECT_EQ(match(s)(
+                // clang-format off
+                pattern | "ab" = 1,
+                pattern | buf  = 2,
+                pattern | _    = 3
+                // clang-format on
+                ),
+            2);
+  EXPECT_EQ(match(std::string{"abcd"})(pattern | buf = 1, pattern | "abcd" = 2, pattern | _ = 3),
+            2);
+}
+
+TEST(StringLiteral, embeddedNul)
+{
+  // Matched up to the first NUL, as C strings.
+  std::string const s = "a";
+  EXPECT_EQ(match(s)(pattern | "b\0c" = 1, pattern | "a\0b" = 2, pattern | _ = 3), 2);
+  EXPECT_EQ(match(std::string_view{"a\0b", 3})(pattern | "a\0b" = 1, pattern | _ = 2), 2);
+}
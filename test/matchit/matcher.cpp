@@ -0,0 +1,87 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <string>
+using namespace matchit;
+
+constexpr auto opcode = matcher(
+    // clang-format off
+    pattern | lit<0x01> = 1,
+    pattern | lit<0x02> = 2,
+    pattern | lit<0x10> = 3,
+    pattern | _         = 0
+    // clang-format on
+);
+
+static_assert(opcode(0x10) == 3);
+static_assert(opcode(0x11) == 0);
+
+TEST(Matcher, reuse)
+{
+  for (int32_t i = 0; i < 3; ++i)
+  {
+    EXPECT_EQ(opcode(0x01), 1);
+    EXPECT_EQ(opcode(0x02), 2);
+    EXPECT_EQ(opcode(0x03), 0);
+  }
+}
+
+TEST(Matcher, multipleValues)
+{
+  auto const m = matcher(
+      // clang-format off
+      pattern | ds(1, _) = 1,
+      pattern | ds(_, 2) = 2,
+      pattern | _        = 0
+      // clang-format on
+  );
+  EXPECT_EQ(m(1, 5), 1);
+  EXPECT_EQ(m(3, 2), 2);
+  EXPECT_EQ(m(3, 3), 0);
+}
+
+TEST(Matcher, outlivesTemporaries)
+{
+  auto const m = []
+  {
+    int32_t lo = 10;
+    return matcher(
+        // clang-format off
+        pattern | (_ * 2 == 10)         = 1,
+        pattern | app(_ + lo, _ > 20)   = 2,
+        pattern | _                     = 0
+        // clang-format on
+    );
+  }();
+  EXPECT_EQ(m(5), 1);
+  EXPECT_EQ(m(11), 2);
+  EXPECT_EQ(m(6), 0);
+}
+
+TEST(Matcher, ids)
+{
+  Id<std::string> s;
+  auto const m = matcher(
+      // clang-format off
+      pattern | "ab"      = std::string{"literal"},
+      pattern | s.at(_)   = s
+      // clang-format on
+  );
+  EXPECT_EQ(m(std::string{"ab"}), "literal");
+  EXPECT_EQ(m(std::string{"cd"}), "cd");
+  EXPECT_EQ(m(std::string{"ef"}), "ef");
+}
+
+TEST(Matcher, statement)
+{
+  int32_t count = 0;
+  auto const m = matcher(
+      // clang-format off
+      pattern | (_ < 0)  = [&] { --count; },
+      pattern | (_ >= 0) = [&] { ++count; }
+      // clang-format on
+  );
+  m(1);
+  m(2);
+  m(-1);
+  EXPECT_EQ(count, 1);
+}
@@ -0,0 +1,113 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+using namespace matchit;
+
+template <typename... PatternPairs>
+constexpr auto analysisOf(PatternPairs const &...)
+{
+  return impl::ArmAnalysis<PatternPairs...>{};
+}
+
+constexpr auto afterWildcard = analysisOf(
+    // clang-format off
+    pattern | lit<1> = 1,
+    pattern | _      = 2,
+    pattern | lit<3> = 3,
+    pattern | _      = 4
+    // clang-format on
+);
+static_assert(afterWildcard.reachable(0) && afterWildcard.reachable(1));
+static_assert(!afterWildcard.reachable(2) && !afterWildcard.reachable(3));
+static_assert(!afterWildcard.allReachable());
+
+constexpr auto literals = analysisOf(
+    // clang-format off
+    pattern | lit<1>                      = 1,
+    pattern | lit<2>                      = 2,
+    pattern | or_(lit<1>, lit<2>)         = 3,
+    pattern | or_(lit<2>, lit<3>)         = 4,
+    pattern | lit<3>                      = 5,
+    pattern | (_ > 0)                     = 6,
+    pattern | or_(_, lit<7>)              = 7,
+    pattern | lit<8>                      = 8
+    // clang-format on
+);
+static_assert(literals.reachable(0) && literals.reachable(1));
+static_assert(!literals.reachable(2));
+static_assert(literals.reachable(3));
+static_assert(!literals.reachable(4));
+static_assert(literals.reachable(5) && literals.reachable(6));
+static_assert(!literals.reachable(7));
+
+constexpr auto guarded = analysisOf(
+    // clang-format off
+    pattern | _ | when(expr(false)) = 1,
+    pattern | _                     = 2
+    // clang-format on
+);
+static_assert(guarded.allReachable());
+
+// Values of patterns tell more, as for matchers.
+constexpr auto facts = impl::analyzePatterns(lit<1>, 2, or_(lit<1>, 2), or_(2, lit<3>), lit<3>,
+                                             (_ > 0), or_(_, lit<7>), (_ < 0));
+static_assert(facts.disjoint(0, 1) && facts.disjoint(0, 4));
+static_assert(!facts.disjoint(1, 3) && facts.disjoint(2, 4));
+static_assert(!facts.disjoint(0, 2));
+static_assert(!facts.disjoint(0, 5) && !facts.disjoint(0, 6));
+static_assert(facts.disjoint(5, 7) && facts.disjoint(4, 7));
+static_assert(!facts.reachable(2) && facts.reachable(3) && !facts.reachable(7));
+
+constexpr auto values = matcher(
+    // clang-format off
+    pattern | 1          = 1,
+    pattern | 2          = 2,
+    pattern | or_(1, 2)  = 3,
+    pattern | or_(1, 3)  = 4,
+    pattern | _          = 5
+    // clang-format on
+);
+static_assert(values.reachable(1) && !values.reachable(2) && values.reachable(3) &&
+              values.reachable(4));
+
+TEST(Reachable, unreachableArmsDropped)
+{
+  auto const m = matcher(
+      // clang-format off
+      pattern | lit<1>              = 1,
+      pattern | lit<2>              = 2,
+      pattern | or_(lit<1>, lit<2>) = 3,
+      pattern | _                   = 4,
+      pattern | lit<5>              = 5
+      // clang-format on
+  );
+  EXPECT_EQ(m(1), 1);
+  EXPECT_EQ(m(2), 2);
+  EXPECT_EQ(m(5), 4);
+  EXPECT_FALSE(m.reachable(2));
+  EXPECT_FALSE(m.reachable(4));
+
+  auto const r = match(2)(
+      // clang-format off
+      pattern | or_(lit<1>, lit<2>) = 1,
+      pattern | lit<2>              = 2,
+      pattern | _                   = 3
+      // clang-format on
+  );
+  EXPECT_EQ(r, 1);
+}
+
+TEST(Reachable, instrumentationSkipsUnreachableArms)
+{
+  using Counters = ArmCounters<struct ReachableSite>;
+  Counters::reset();
+  match<Counters>(5)(
+      // clang-format off
+      pattern | lit<1>              = 1,
+      pattern | or_(lit<1>, lit<1>) = 2,
+      pattern | _                   = 3
+      // clang-format on
+  );
+  EXPECT_EQ(Counters::arm(0).attempts.load(), 1U);
+  EXPECT_EQ(Counters::arm(1).attempts.load(), 0U);
+  EXPECT_EQ(Counters::arm(2).hits.load(), 1U);
+}
@@ -0,0 +1,124 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <string_view>
+using namespace matchit;
+
+constexpr char kDigits[] = "[0-9]+";
+constexpr char kLine[] = "(\\w+) \\[(INFO|WARN|ERROR)\\] (.*)";
+constexpr char kOptional[] = "a(b)?c";
+constexpr char kLazy[] = "(.*?)(,.*)";
+constexpr char kCounted[] = "x{2,3}y{2}z{1,}";
+constexpr char kClasses[] = "[^a-c]\\d\\s[\\w-]";
+constexpr char kNested[] = "((ab)*|c)+";
+
+static_assert(matched("2021", regex<kDigits>()));
+static_assert(!matched("20x1", regex<kDigits>()));
+static_assert(impl::Regex<impl::RegexSource<kLine>>::nbGroups == 3);
+
+TEST(Regex, wholeValue)
+{
+  EXPECT_TRUE(matched("123", regex<kDigits>()));
+  EXPECT_TRUE(matched(std::string{"0"}, regex<kDigits>()));
+  EXPECT_FALSE(matched("", regex<kDigits>()));
+  EXPECT_FALSE(matched("12a", regex<kDigits>()));
+  EXPECT_FALSE(matched(" 12", regex<kDigits>()));
+
+  EXPECT_TRUE(matched("xxyyz", regex<kCounted>()));
+  EXPECT_TRUE(matched("xxxyyzzz", regex<kCounted>()));
+  EXPECT_FALSE(matched("xyyz", regex<kCounted>()));
+  EXPECT_FALSE(matched("xxxxyyz", regex<kCounted>()));
+  EXPECT_FALSE(matched("xxyyyz", regex<kCounted>()));
+  EXPECT_FALSE(matched("xxyy", regex<kCounted>()));
+
+  EXPECT_TRUE(matched("d1 -", regex<kClasses>()));
+  EXPECT_TRUE(matched("z9\t_", regex<kClasses>()));
+  EXPECT_FALSE(matched("a1 -", regex<kClasses>()));
+  EXPECT_FALSE(matched("d1x-", regex<kClasses>()));
+
+  EXPECT_TRUE(matched("c", regex<kNested>()));
+  EXPECT_TRUE(matched("ababcab", regex<kNested>()));
+  EXPECT_TRUE(matched("", regex<kNested>()));
+  EXPECT_FALSE(matched("aba", regex<kNested>()));
+}
+
+TEST(Regex, captures)
+{
+  Id<std::string_view> source;
+  Id<std::string_view> level;
+  Id<std::string_view> message;
+  auto const line = std::string{"disk [WARN] 91% used"};
+  match(line)(pattern | regex<kLine>(source, level, message) = [&]
+              {
+                EXPECT_EQ(*source, "disk");
+                EXPECT_EQ(*level, "WARN");
+                EXPECT_EQ(*message, "91% used");
+                // The captures view the value, without copies.
+                EXPECT_EQ((*source).data(), line.data());
+              });
+
+  Id<std::string_view> b;
+  match("ac")(pattern | regex<kOptional>(b) = [&] { EXPECT_TRUE((*b).empty()); });
+  match("abc")(pattern | regex<kOptional>(b) = [&] { EXPECT_EQ(*b, "b"); });
+
+  Id<std::string_view> head;
+  Id<std::string_view> tail;
+  match("a,b,c")(pattern | regex<kLazy>(head, tail) = [&]
+                 {
+                   EXPECT_EQ(*head, "a");
+                   EXPECT_EQ(*tail, ",b,c");
+                 });
+}
+
+int32_t route(std::string_view line)
+{
+  Id<std::string_view> source;
+  Id<std::string_view> message;
+  return match(line)(
+      // clang-format off
+      pattern | regex<kLine>(_, "ERROR", _)                                  = 1,
+      pattern | regex<kLine>(source, "WARN", _) | when(source == "disk")     = 2,
+      pattern | or_(regex<kLine>(_, "WARN", message), regex<kDigits>())      = 3,
+      pattern | and_(regex<kLine>(ooo), not_("boot [INFO] ok"))              = 4,
+      pattern | _                                                            = 0
+      // clang-format on
+  );
+}
+
+TEST(Regex, compose)
+{
+  EXPECT_EQ(route("net [ERROR] down"), 1);
+  EXPECT_EQ(route("disk [WARN] full"), 2);
+  EXPECT_EQ(route("net [WARN] slow"), 3);
+  EXPECT_EQ(route("42"), 3);
+  EXPECT_EQ(route("net [INFO] up"), 4);
+  EXPECT_EQ(route("boot [INFO] ok"), 0);
+  EXPECT_EQ(route("net [DEBUG] up"), 0);
+}
+
+constexpr char kAlternatives[] = "(a|ab)(c|bcd)(d*)";
+
+TEST(Regex, leftmostPriority)
+{
+  Id<std::string_view> x;
+  Id<std::string_view> y;
+  Id<std::string_view> z;
+  match("abcd")(pattern | regex<kAlternatives>(x, y, z) = [&]
+                {
+                  EXPECT_EQ(*x, "a");
+                  EXPECT_EQ(*y, "bcd");
+                  EXPECT_EQ(*z, "");
+                });
+}
+
+// Needs more DFA states than kept, so that the NFA tells values apart.
+constexpr char kWide[] = "(.*)a.{9}";
+
+TEST(Regex, withoutDfa)
+{
+  static_assert(!impl::Regex<impl::RegexSource<kWide>>::hasDfa);
+  Id<std::string_view> prefix;
+  EXPECT_TRUE(matched("xxa123456789", regex<kWide>(_)));
+  EXPECT_FALSE(matched("xxb123456789", regex<kWide>(_)));
+  match("aaaaaaaaaaaa")(pattern | regex<kWide>(prefix) = [&] { EXPECT_EQ(*prefix, "aa"); });
+}
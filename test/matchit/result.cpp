@@ -0,0 +1,91 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <array>
+#include <memory>
+#include <string>
+using namespace matchit;
+
+TEST(Result, moveOnly)
+{
+  auto const f = [](int32_t x)
+  {
+    return match(x)(
+        // clang-format off
+        pattern | (_ > 0) = [] { return std::make_unique<int32_t>(1); },
+        pattern | _       = [] { return std::unique_ptr<int32_t>{}; }
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(*f(1), 1);
+  EXPECT_EQ(f(0), nullptr);
+}
+
+class Handle
+{
+public:
+  explicit Handle(int32_t id) : mId{id} {}
+  Handle(Handle const &) = delete;
+  Handle(Handle &&) = delete;
+  int32_t id() const { return mId; }
+
+private:
+  int32_t mId;
+};
+
+TEST(Result, notDefaultConstructibleNorMovable)
+{
+  Id<int32_t> i;
+  auto const h = match(5)(
+      // clang-format off
+      pattern | i.at(_ > 0) = [&] { return Handle{*i}; },
+      pattern | _           = [] { return Handle{0}; }
+      // clang-format on
+  );
+  EXPECT_EQ(h.id(), 5);
+}
+
+TEST(Result, reference)
+{
+  std::array<std::string, 3> table{"zero", "one", "many"};
+  auto const f = [&](int32_t x) -> std::string &
+  {
+    return match(x)(
+        // clang-format off
+        pattern | 0 = [&]() -> std::string & { return table[0]; },
+        pattern | 1 = [&]() -> std::string & { return table[1]; },
+        pattern | _ = [&]() -> std::string & { return table[2]; }
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(&f(1), &table[1]);
+  f(5) = "lots";
+  EXPECT_EQ(table[2], "lots");
+
+  auto const r = tryMatch(3)(pattern | 3 = [&]() -> std::string & { return table[0]; });
+  EXPECT_EQ(&r->get(), &table[0]);
+}
+
+constexpr auto positive(int32_t x)
+{
+  return tryMatch(x)(pattern | (_ > 0) = x);
+}
+
+static_assert(positive(3) == 3);
+static_assert(!positive(-3).has_value());
+
+// Handlers of many arms are invoked via a table.
+template <size_t... I>
+Handle manyArms(int32_t x, std::index_sequence<I...>)
+{
+  return match(x)(pattern | static_cast<int32_t>(I) =
+                      [] { return Handle{static_cast<int32_t>(I)}; }...,
+                  pattern | _ = [] { return Handle{-1}; });
+}
+
+TEST(Result, manyArms)
+{
+  constexpr auto arms = std::make_index_sequence<impl::kNB_INLINE_ARMS + 8>{};
+  EXPECT_EQ(manyArms(0, arms).id(), 0);
+  EXPECT_EQ(manyArms(35, arms).id(), 35);
+  EXPECT_EQ(manyArms(100, arms).id(), -1);
+}
@@ -0,0 +1,89 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+using namespace matchit;
+
+int32_t sharedFib(int32_t n)
+{
+  static Id<int32_t> x;
+  static auto const m = sharedMatcher(
+      // clang-format off
+      pattern | 0 = 0,
+      pattern | 1 = 1,
+      // x is still bound to n after the recursive calls.
+      pattern | x = [&] { return sharedFib(*x - 1) + sharedFib(*x - 2); }
+      // clang-format on
+  );
+  return m(n);
+}
+
+TEST(SharedMatcher, recursive)
+{
+  EXPECT_EQ(sharedFib(15), 610);
+}
+
+TEST(SharedMatcher, nested)
+{
+  Id<int32_t> x;
+  Id<int32_t> y;
+  auto const inner = sharedMatcher(
+      // clang-format off
+      pattern | y = [&] { return *x * 10 + *y; }
+      // clang-format on
+  );
+  auto const outer = sharedMatcher(
+      // clang-format off
+      pattern | x = [&] { return inner(*x + 1); }
+      // clang-format on
+  );
+  EXPECT_EQ(outer(3), 34);
+}
+
+TEST(SharedMatcher, values)
+{
+  Id<std::string> s;
+  auto const m = sharedMatcher(
+      // clang-format off
+      pattern | s.at(_ != "") = [&] { return *s + "!"; },
+      pattern | _             = std::string{}
+      // clang-format on
+  );
+  EXPECT_EQ(m(std::string("ab")), "ab!");
+  EXPECT_EQ(m(std::string{}), "");
+  EXPECT_EQ(m.tryMatch(std::string("cd")), "cd!");
+}
+
+TEST(SharedMatcher, threads)
+{
+  Id<int32_t> x;
+  Id<int32_t> y;
+  auto const m = sharedMatcher(
+      // clang-format off
+      pattern | ds(x, x) = [&] { return *x * 2; },
+      pattern | ds(x, y) = [&] { return *x - *y; }
+      // clang-format on
+  );
+  std::vector<std::thread> threads;
+  std::vector<int32_t> wrong(8);
+  for (int32_t t = 0; t < 8; ++t)
+  {
+    threads.emplace_back(
+        [&, t]
+        {
+          for (int32_t i = 0; i < 20000; ++i)
+          {
+            auto const v = std::make_tuple(i, i % 3 == 0 ? i : t);
+            auto const expected = i % 3 == 0 || i == t ? i * 2 : i - t;
+            wrong[static_cast<size_t>(t)] += m(v) != expected;
+          }
+        });
+  }
+  for (auto &t : threads)
+  {
+    t.join();
+  }
+  EXPECT_EQ(wrong, std::vector<int32_t>(8));
+}
@@ -0,0 +1,71 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+using namespace matchit;
+
+constexpr auto half(int32_t x)
+{
+  return tryMatch(x)(
+      // clang-format off
+      pattern | lit<2> = 1,
+      pattern | lit<4> = 2,
+      pattern | lit<8> = 4
+      // clang-format on
+  );
+}
+
+static_assert(half(4) == 2);
+static_assert(!half(5).has_value());
+
+TEST(TryMatch, expression)
+{
+  Id<int32_t> i;
+  auto const f = [&](int32_t x)
+  {
+    return tryMatch(x)(
+        // clang-format off
+        pattern | i.at(_ > 0) = i,
+        pattern | 0           = 0
+        // clang-format on
+    );
+  };
+  EXPECT_EQ(f(3), 3);
+  EXPECT_EQ(f(0), 0);
+  EXPECT_FALSE(f(-1).has_value());
+  EXPECT_EQ(f(-1).value_or(-2), -2);
+}
+
+TEST(TryMatch, multipleValues)
+{
+  EXPECT_EQ(tryMatch(1, 2)(pattern | ds(1, _) = 1), 1);
+  EXPECT_FALSE(tryMatch(2, 2)(pattern | ds(1, _) = 1).has_value());
+}
+
+TEST(TryMatch, statement)
+{
+  int32_t count = 0;
+  auto const f = [&](int32_t x)
+  {
+    return tryMatch(x)(
+        // clang-format off
+        pattern | lit<1> = [&] { count += 1; },
+        pattern | lit<2> = [&] { count += 2; }
+        // clang-format on
+    );
+  };
+  EXPECT_TRUE(f(2));
+  EXPECT_FALSE(f(3));
+  EXPECT_EQ(count, 2);
+}
+
+TEST(TryMatch, matcher)
+{
+  auto const m = matcher(
+      // clang-format off
+      pattern | (_ > 5) = 1,
+      pattern | (_ < 0) = 2
+      // clang-format on
+  );
+  EXPECT_EQ(m.tryMatch(7), 1);
+  EXPECT_FALSE(m.tryMatch(3).has_value());
+  EXPECT_THROW(m(3), std::logic_error);
+}
@@ -0,0 +1,80 @@
+#include "matchit.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <variant>
+using namespace matchit;
+
+using Message = std::variant<int32_t, std::string, double, char>;
+
+constexpr auto asInt = [](auto const pat) { return as<int32_t>(pat); };
+
+static_assert(impl::VariantDispatch<
+              Message, std::tuple<decltype(as<int32_t>(_)), decltype(as<char>(_))>>::enabled);
+static_assert(!impl::VariantDispatch<
+              Message, std::tuple<decltype(as<int32_t>(_)), decltype(as<float>(_))>>::enabled);
+static_assert(!impl::VariantDispatch<int32_t, std::tuple<decltype(as<int32_t>(_)),
+                                                         decltype(as<int32_t>(_))>>::enabled);
+
+auto describe(Message const &m)
+{
+  Id<int32_t> i;
+  Id<std::string> s;
+  return match(m)(
+      // clang-format off
+      pattern | asInt(0)                     = std::string{"zero"},
+      pattern | as<std::string>(s)           = [&] { return "string " + *s; },
+      pattern | as<int32_t>(i) | when(i > 0) = std::string{"positive"},
+      pattern | as<int32_t>(_)               = std::string{"negative"},
+      pattern | as<char>('c')                = std::string{"c"},
+      pattern | _                            = std::string{"other"}
+      // clang-format on
+  );
+}
+
+TEST(Variant, dispatchByIndex)
+{
+  EXPECT_EQ(describe(0), "zero");
+  EXPECT_EQ(describe(3), "positive");
+  EXPECT_EQ(describe(-3), "negative");
+  EXPECT_EQ(describe(std::string{"abc"}), "string abc");
+  EXPECT_EQ(describe('c'), "c");
+  EXPECT_EQ(describe('d'), "other");
+  EXPECT_EQ(describe(1.0), "other");
+}
+
+TEST(Variant, statement)
+{
+  int32_t sum = 0;
+  for (Message const &m : {Message{1}, Message{'a'}, Message{2.5}, Message{2}})
+  {
+    match(m)(
+        // clang-format off
+        pattern | as<char>(_)    = [&] { sum += 10; },
+        pattern | as<int32_t>(_) = [&] { sum += 1; }
+        // clang-format on
+    );
+  }
+  EXPECT_EQ(sum, 12);
+}
+
+struct Throwing
+{
+  Throwing() = default;
+  Throwing(Throwing const &) { throw std::runtime_error{"copy"}; }
+  Throwing &operator=(Throwing const &) = default;
+};
+
+TEST(Variant, valueless)
+{
+  std::variant<int32_t, Throwing> v = 1;
+  EXPECT_THROW(v = Throwing{}, std::runtime_error);
+  ASSERT_TRUE(v.valueless_by_exception());
+  auto const result = match(v)(
+      // clang-format off
+      pattern | as<int32_t>(_)  = 1,
+      pattern | as<Throwing>(_) = 2,
+      pattern | _               = 3
+      // clang-format on
+  );
+  EXPECT_EQ(result, 3);
+}